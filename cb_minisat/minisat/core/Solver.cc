@@ -45,6 +45,11 @@ static IntOption     opt_restart_first     (_cat, "rfirst",      "The base resta
 static DoubleOption  opt_restart_inc       (_cat, "rinc",        "Restart interval increase factor", 2, DoubleRange(1, false, HUGE_VAL, false));
 static DoubleOption  opt_garbage_frac      (_cat, "gc-frac",     "The fraction of wasted memory allowed before a garbage collection is triggered",  0.20, DoubleRange(0, false, HUGE_VAL, false));
 static IntOption     opt_min_learnts_lim   (_cat, "min-learnts", "Minimum learnt clause limit",  0, IntRange(0, INT32_MAX));
+static BoolOption    opt_glucose_restart   (_cat, "glucose",     "Restart on the recent LBD average instead of a fixed sequence", false);
+static DoubleOption  opt_restart_K         (_cat, "K",           "Restart when the recent LBD average times K exceeds the global one", 0.8, DoubleRange(0, false, 1, false));
+static DoubleOption  opt_restart_R         (_cat, "R",           "Block restarts when the trail is R times longer than the recent average", 1.4, DoubleRange(1, false, HUGE_VAL, false));
+static IntOption     opt_core_lbd          (_cat, "core-lbd",    "Learnt clauses up to this LBD are never removed", 2, IntRange(0, INT32_MAX));
+static IntOption     opt_tier2_lbd         (_cat, "tier2-lbd",   "Learnt clauses up to this LBD are kept while they are used", 6, IntRange(0, INT32_MAX));
 
 
 //=================================================================================================
@@ -79,13 +84,19 @@ Solver::Solver() :
   , learntsize_adjust_start_confl (100)
   , learntsize_adjust_inc         (1.5)
 
+  , glucose_restart  (opt_glucose_restart)
+  , restart_K        (opt_restart_K)
+  , restart_R        (opt_restart_R)
+  , core_lbd         (opt_core_lbd)
+  , tier2_lbd        (opt_tier2_lbd)
+
     // Statistics: (formerly in 'SolverStats')
     //
   , solves(0), starts(0), decisions(0), rnd_decisions(0), propagations(0), conflicts(0)
   , dec_vars(0), num_clauses(0), num_learnts(0), clauses_literals(0), learnts_literals(0), max_literals(0), tot_literals(0)
 
   , watches            (WatcherDeleted(ca))
-  , order_heap         (VarOrderLt(activity))
+  , order_heap         (VarOrderLt(activity, priority))
   , ok                 (true)
   , cla_inc            (1)
   , var_inc            (1)
@@ -94,7 +105,18 @@ Solver::Solver() :
   , simpDB_props       (0)
   , progress_estimate  (0)
   , remove_satisfied   (false)
+  , implicit_bin       (true)
   , next_var           (0)
+  , propagator_confl   (CRef_Undef)
+  , exchange           (NULL)
+  , brancher           (NULL)
+  , exchange_id        (0)
+  , enum_base          (0)
+  , enum_projected     (false)
+  , enum_done          (true)
+  , lbd_stamp          (0)
+  , sum_lbd            (0)
+  , core_learnts       (0)
 
     // Resource constraints:
     //
@@ -102,10 +124,8 @@ Solver::Solver() :
   , propagation_budget (-1)
   , asynch_interrupt   (false)
 {
-    /*****************************************************************************
-     * cb_minisat
-     ****************************************************************************/
-    callback = &callback_nop;
+    lbd_queue.init(50);
+    trail_queue.init(5000);
 }
 
 
@@ -132,6 +152,9 @@ Var Solver::newVar(lbool upol, bool dvar)
 
     watches  .init(mkLit(v, false));
     watches  .init(mkLit(v, true ));
+    watches_bin.reserve(mkLit(v, true));
+    watches_bin[mkLit(v, false)].clear();
+    watches_bin[mkLit(v, true )].clear();
     assigns  .insert(v, l_Undef);
     vardata  .insert(v, mkVarData(CRef_Undef, 0));
     activity .insert(v, rnd_init_act ? drand(random_seed) * 0.00001 : 0);
@@ -139,6 +162,7 @@ Var Solver::newVar(lbool upol, bool dvar)
     polarity .insert(v, true);
     user_pol .insert(v, upol);
     decision .reserve(v);
+    priority .insert(v, 0);
     trail    .capacity(v+1);
     setDecisionVar(v, dvar);
     return v;
@@ -156,6 +180,144 @@ void Solver::releaseVar(Lit l)
 }
 
 
+/*****************************************************************************
+ * cb_minisat
+ ****************************************************************************/
+void Solver::attachPropagator(Propagator* prop, Var first, Var last, bool negative)
+{
+    PropagatorRef ref = {prop, first, last, negative};
+    propagators.push(ref);
+}
+
+
+void Solver::attachExchange(ClauseExchange* x, int id)
+{
+    exchange    = x;
+    exchange_id = id;
+}
+
+
+void Solver::attachBrancher(Brancher* b)
+{
+    brancher = b;
+}
+
+
+void Solver::enumStart(const vec<Lit>& assumps)
+{
+    enumStart(assumps, vec<Var>());
+    enum_projected = false;
+}
+
+
+void Solver::enumStart(const vec<Lit>& assumps, const vec<Var>& projection)
+{
+    if (enum_projection.size() > 0 || projection.size() > 0){
+        for (int i = 0; i < enum_projection.size(); i++)
+            priority[enum_projection[i]] = 0;
+        projection.copyTo(enum_projection);
+        for (int i = 0; i < enum_projection.size(); i++)
+            priority[enum_projection[i]] = 1;
+        rebuildOrderHeap();
+    }
+    enum_projected = true;
+
+    assumps.copyTo(enum_path);
+    enum_flipped.clear();
+    enum_flipped.growTo(enum_path.size(), false);
+    enum_base = enum_path.size();
+    enum_done = false;
+}
+
+
+/*_________________________________________________________________________________________________
+|
+|  enumNext : ()  ->  [lbool]
+|
+|  Description:
+|    cb_minisat: solves under 'enum_path'. The subspace of a model's decisions holds that model only,
+|    so the decisions are appended to the path, and the search backtracks chronologically: flipped
+|    decisions at the end are dropped and the last open one is flipped. An unsatisfiable subspace is
+|    left the same way, after cutting the path below the deepest assumption in the final conflict.
+|    Learnt clauses never depend on the path, so they stay valid and no blocking clauses are needed.
+|________________________________________________________________________________________________@*/
+lbool Solver::enumNext()
+{
+    while (!enum_done){
+        enum_path.copyTo(assumptions);
+        lbool status = enumSolve();
+        if (status == l_Undef)
+            return l_Undef;
+
+        if (status == l_True){
+            for (int i = 0; i < model_decisions.size(); i++){
+                enum_path.push(model_decisions[i]);
+                enum_flipped.push(false); }
+        }else{
+            int keep = 0;
+            for (int i = enum_path.size() - 1; i >= 0 && keep == 0; i--)
+                if (conflict.has(~enum_path[i]))
+                    keep = i + 1;
+            if (keep <= enum_base){
+                enum_done = true;
+                break; }
+            enum_path.shrink(enum_path.size() - keep);
+            enum_flipped.shrink(enum_flipped.size() - keep);
+        }
+
+        while (enum_path.size() > enum_base && enum_flipped.last()){
+            enum_path.pop();
+            enum_flipped.pop(); }
+        if (enum_path.size() == enum_base)
+            enum_done = true;
+        else{
+            enum_path.last()    = ~enum_path.last();
+            enum_flipped.last() = true;
+        }
+
+        if (status == l_True)
+            return l_True;
+    }
+    return l_False;
+}
+
+
+// cb_minisat: clauses from 'exchange' are simplified against the top-level assignment and added
+// as learnt clauses. Returns false if one of them is falsified.
+bool Solver::importClauses()
+{
+    assert(decisionLevel() == 0);
+    while (exchange->fetch(exchange_id, exchange_tmp)){
+        int i, j;
+        for (i = j = 0; i < exchange_tmp.size(); i++)
+            if (value(exchange_tmp[i]) == l_True)
+                break;
+            else if (value(exchange_tmp[i]) == l_Undef)
+                exchange_tmp[j++] = exchange_tmp[i];
+        if (i < exchange_tmp.size())
+            continue;
+        exchange_tmp.shrink(i - j);
+
+        if (exchange_tmp.size() == 0)
+            return ok = false;
+        else if (exchange_tmp.size() == 1)
+            uncheckedEnqueue(exchange_tmp[0]);
+        else if (exchange_tmp.size() == 2)
+            attachBin(exchange_tmp[0], exchange_tmp[1], true);
+        else{
+            // The LBD is not known here, the clause starts in tier2 and has to earn its keep.
+            CRef cr = ca.alloc(exchange_tmp, true);
+            learnts.push(cr);
+            attachClause(cr);
+            ca[cr].lbd(exchange_tmp.size() <= core_lbd ? exchange_tmp.size() : tier2_lbd);
+            ca[cr].used(true);
+            claBumpActivity(ca[cr]);
+        }
+    }
+    return true;
+}
+
+
 bool Solver::addClause_(vec<Lit>& ps)
 {
     assert(decisionLevel() == 0);
@@ -176,7 +338,9 @@ bool Solver::addClause_(vec<Lit>& ps)
     else if (ps.size() == 1){
         uncheckedEnqueue(ps[0]);
         return ok = (propagate() == CRef_Undef);
-    }else{
+    }else if (ps.size() == 2 && implicit_bin)
+        attachBin(ps[0], ps[1], false);
+    else{
         CRef cr = ca.alloc(ps, false);
         clauses.push(cr);
         attachClause(cr);
@@ -196,6 +360,17 @@ void Solver::attachClause(CRef cr){
 }
 
 
+// cb_minisat: an implicit binary clause is just the two watchers, there is nothing in 'ca' to
+// look at when it propagates, and it is only ever removed by 'removeSatisfiedBin()'.
+void Solver::attachBin(Lit p, Lit q, bool learnt){
+    assert(p != q && p != ~q);
+    watches_bin[~p].push(BinWatcher(q, learnt));
+    watches_bin[~q].push(BinWatcher(p, learnt));
+    if (learnt) num_learnts++, learnts_literals += 2;
+    else        num_clauses++, clauses_literals += 2;
+}
+
+
 void Solver::detachClause(CRef cr, bool strict){
     const Clause& c = ca[cr];
     assert(c.size() > 1);
@@ -240,11 +415,17 @@ void Solver::cancelUntil(int level) {
             assigns [x] = l_Undef;
             if (phase_saving > 1 || (phase_saving == 1 && c > trail_lim.last()))
                 polarity[x] = sign(trail[c]);
+            // cb_minisat: reasons explained by a propagator are owned by the assignment.
+            if (vardata[x].prop >= 0 && vardata[x].reason != CRef_Undef)
+                ca.free(vardata[x].reason);
             insertVarOrder(x);
         }
         qhead = trail_lim[level];
         trail.shrink(trail.size() - trail_lim[level]);
         trail_lim.shrink(trail_lim.size() - level);
+
+        for (int k = 0; k < propagators.size(); k++)
+            propagators[k].prop->backtrack(*this, level);
     }
 }
 
@@ -257,8 +438,24 @@ Lit Solver::pickBranchLit()
 {
     Var next = var_Undef;
 
+    // cb_minisat: while a projection variable is open, only those may be decided. They sort
+    // first in 'order_heap', so it is enough to look at the top.
+    bool projecting = false;
+    if (enum_projected){
+        while (!order_heap.empty() && (value(order_heap[0]) != l_Undef || !decision[order_heap[0]]))
+            order_heap.removeMin();
+        projecting = !order_heap.empty() && priority[order_heap[0]];
+    }
+
+    // cb_minisat: structural decision:
+    if (brancher != NULL){
+        Lit p = brancher->decide(*this);
+        if (p != lit_Undef && (!projecting || priority[var(p)]))
+            return p;
+    }
+
     // Random decision:
-    if (drand(random_seed) < random_var_freq && !order_heap.empty()){
+    if (!projecting && drand(random_seed) < random_var_freq && !order_heap.empty()){
         next = order_heap[irand(random_seed,order_heap.size())];
         if (value(next) == l_Undef && decision[next])
             rnd_decisions++;
@@ -313,12 +510,32 @@ void Solver::analyze(CRef confl, vec<Lit>& out_learnt, int& out_btlevel)
 
     do{
         assert(confl != CRef_Undef); // (otherwise should be UIP)
-        Clause& c = ca[confl];
-
-        if (c.learnt())
-            claBumpActivity(c);
+        const Lit* c    = bin_confl;
+        int        size = 2;
+
+        // cb_minisat: 'CRef_Bin' is the binary conflict 'propagate()' left in 'bin_confl', or the reason of 'p':
+        if (confl == CRef_Bin){
+            if (p != lit_Undef){
+                bin_confl[0] = p;
+                bin_confl[1] = vardata[var(p)].bin; }
+        }else{
+            Clause& cl = ca[confl];
+            c    = cl;
+            size = cl.size();
+
+            if (cl.learnt()){
+                claBumpActivity(cl);
+                // cb_minisat: clauses that keep taking part in conflicts are promoted to a better tier.
+                cl.used(true);
+                if (cl.lbd() > (uint32_t)core_lbd){
+                    int lbd = computeLBD(cl);
+                    if (lbd + 1 < (int)cl.lbd())
+                        cl.lbd(lbd);
+                }
+            }
+        }
 
-        for (int j = (p == lit_Undef) ? 0 : 1; j < c.size(); j++){
+        for (int j = (p == lit_Undef) ? 0 : 1; j < size; j++){
             Lit q = c[j];
 
             if (!seen[var(q)] && level(var(q)) > 0){
@@ -335,28 +552,7 @@ void Solver::analyze(CRef confl, vec<Lit>& out_learnt, int& out_btlevel)
         while (!seen[var(trail[index--])]);
         p     = trail[index+1];
         
-        // cb_minisat
-        if (cb_child(var(p))) {
-            Lit q = vardata[var(p)].cb_reason;
-            if (!seen[var(q)] && level(var(q)) > 0){
-                varBumpActivity(var(q));
-                seen[var(q)] = 1;
-                if (level(var(q)) >= decisionLevel())
-                    pathC++;
-                else
-                    out_learnt.push(q);
-            }
-
-            while (p != q) {
-                if (seen[var(p)]) {
-                    seen[var(p)] = 0;
-                    pathC--;
-                }
-                p = trail[index--];
-            }
-        }
-
-        confl = reason(var(p));
+        confl = lazyReason(var(p));
         seen[var(p)] = 0;
         pathC--;
 
@@ -369,17 +565,21 @@ void Solver::analyze(CRef confl, vec<Lit>& out_learnt, int& out_btlevel)
     out_learnt.copyTo(analyze_toclear);
     if (ccmin_mode == 2){
         for (i = j = 1; i < out_learnt.size(); i++)
-            if (reason(var(out_learnt[i])) == CRef_Undef || !litRedundant(out_learnt[i]))
+            if (lazyReason(var(out_learnt[i])) == CRef_Undef || !litRedundant(out_learnt[i]))
                 out_learnt[j++] = out_learnt[i];
         
     }else if (ccmin_mode == 1){
         for (i = j = 1; i < out_learnt.size(); i++){
             Var x = var(out_learnt[i]);
 
-            if (reason(x) == CRef_Undef)
+            if (lazyReason(x) == CRef_Undef)
                 out_learnt[j++] = out_learnt[i];
-            else{
-                Clause& c = ca[reason(var(out_learnt[i]))];
+            else if (reason(x) == CRef_Bin){
+                Lit q = vardata[x].bin;
+                if (!seen[var(q)] && level(var(q)) > 0)
+                    out_learnt[j++] = out_learnt[i];
+            }else{
+                Clause& c = ca[reason(x)];
                 for (int k = 1; k < c.size(); k++)
                     if (!seen[var(c[k])] && level(var(c[k])) > 0){
                         out_learnt[j++] = out_learnt[i];
@@ -421,21 +621,22 @@ bool Solver::litRedundant(Lit p)
     assert(seen[var(p)] == seen_undef || seen[var(p)] == seen_source);
     assert(reason(var(p)) != CRef_Undef);
 
-    Clause*               c     = &ca[reason(var(p))];
+    // (reasons may be allocated on demand, so hold a reference rather than a pointer into 'ca')
+    CRef                  c     = reason(var(p));
     vec<ShrinkStackElem>& stack = analyze_stack;
     stack.clear();
 
     for (uint32_t i = 1; ; i++){
-        if (i < (uint32_t)c->size()){
+        if (i < (c == CRef_Bin ? 2 : (uint32_t)ca[c].size())){
             // Checking 'p'-parents 'l':
-            Lit l = (*c)[i];
+            Lit l = c == CRef_Bin ? vardata[var(p)].bin : ca[c][i];
             
             // Variable at level 0 or previously removable:
             if (level(var(l)) == 0 || seen[var(l)] == seen_source || seen[var(l)] == seen_removable){
                 continue; }
             
             // Check variable can not be removed for some local reason:
-            if (reason(var(l)) == CRef_Undef || seen[var(l)] == seen_failed){
+            if (lazyReason(var(l)) == CRef_Undef || seen[var(l)] == seen_failed){
                 stack.push(ShrinkStackElem(0, p));
                 for (int i = 0; i < stack.size(); i++)
                     if (seen[var(stack[i].l)] == seen_undef){
@@ -450,7 +651,7 @@ bool Solver::litRedundant(Lit p)
             stack.push(ShrinkStackElem(i, p));
             i  = 0;
             p  = l;
-            c  = &ca[reason(var(p))];
+            c  = reason(var(p));
         }else{
             // Finished with current element 'p' and reason 'c':
             if (seen[var(p)] == seen_undef){
@@ -464,7 +665,7 @@ bool Solver::litRedundant(Lit p)
             // Continue with top element on stack:
             i  = stack.last().i;
             p  = stack.last().l;
-            c  = &ca[reason(var(p))];
+            c  = reason(var(p));
 
             stack.pop();
         }
@@ -496,9 +697,12 @@ void Solver::analyzeFinal(Lit p, LSet& out_conflict)
     for (int i = trail.size()-1; i >= trail_lim[0]; i--){
         Var x = var(trail[i]);
         if (seen[x]){
-            if (reason(x) == CRef_Undef){
+            if (lazyReason(x) == CRef_Undef){
                 assert(level(x) > 0);
                 out_conflict.insert(~trail[i]);
+            }else if (reason(x) == CRef_Bin){
+                if (level(var(vardata[x].bin)) > 0)
+                    seen[var(vardata[x].bin)] = 1;
             }else{
                 Clause& c = ca[reason(x)];
                 for (int j = 1; j < c.size(); j++)
@@ -519,23 +723,6 @@ void Solver::uncheckedEnqueue(Lit p, CRef from)
     assigns[var(p)] = lbool(!sign(p));
     vardata[var(p)] = mkVarData(from, decisionLevel());
     trail.push_(p);
-
-    /*****************************************************************************
-     * cb_minisat
-     ****************************************************************************/
-    vec<Lit> ps;
-    callback(callback_obj_pt, assigns, trail, ps);
-    Lit cb_reason = trail.last();
-    for (int i=0; i<ps.size(); i++) {
-        // only assign l_Undef variables
-        if (value(var(ps[i])) == l_Undef) {
-            assigns[var(ps[i])] = sign(ps[i])? l_False:l_True;
-            vardata[var(ps[i])] = mkVarData(from, decisionLevel(), cb_reason);
-            trail.push_(ps[i]);
-        } else {
-            assert( value(var(ps[i])) == (sign(ps[i]) ? l_False:l_True) );
-        }
-    }
 }
 
 
@@ -555,11 +742,34 @@ CRef Solver::propagate()
     CRef    confl     = CRef_Undef;
     int     num_props = 0;
 
+    if (propagator_confl != CRef_Undef){
+        ca.free(propagator_confl);
+        propagator_confl = CRef_Undef; }
+
     while (qhead < trail.size()){
         Lit            p   = trail[qhead++];     // 'p' is enqueued fact to propagate.
+        num_props++;
+
+        // cb_minisat: implicit binary clauses, the reason is the other literal '~p':
+        vec<BinWatcher>& wbin = watches_bin[p];
+        for (int k = 0; k < wbin.size(); k++){
+            Lit imp = wbin[k].other;
+            if (value(imp) == l_False){
+                bin_confl[0] = imp;
+                bin_confl[1] = ~p;
+                confl = CRef_Bin;
+                break;
+            }else if (value(imp) == l_Undef){
+                uncheckedEnqueue(imp, CRef_Bin);
+                vardata[var(imp)].bin = ~p;
+            }
+        }
+        if (confl != CRef_Undef){
+            qhead = trail.size();
+            break; }
+
         vec<Watcher>&  ws  = watches.lookup(p);
         Watcher        *i, *j, *end;
-        num_props++;
 
         for (i = j = (Watcher*)ws, end = i + ws.size();  i != end;){
             // Try to avoid inspecting the clause:
@@ -603,6 +813,37 @@ CRef Solver::propagate()
         NextClause:;
         }
         ws.shrink(i - j);
+
+        /*****************************************************************************
+         * cb_minisat
+         ****************************************************************************/
+        for (int k = 0; confl == CRef_Undef && k < propagators.size(); k++){
+            if (var(p) < propagators[k].first || var(p) > propagators[k].last || (sign(p) && !propagators[k].negative))
+                continue;
+
+            vec<Lit>& ps = propagator_tmp;
+            ps.clear();
+            if (!propagators[k].prop->propagate(*this, p, ps)){
+                confl = propagator_confl = ca.alloc(ps, false);
+                qhead = trail.size();
+                break;
+            }
+
+            for (int l = 0; l < ps.size(); l++){
+                if (value(ps[l]) == l_Undef){
+                    uncheckedEnqueue(ps[l]);
+                    vardata[var(ps[l])].prop = k;
+                }else if (value(ps[l]) == l_False){
+                    // The reason of an implied literal that is already false is a conflict clause:
+                    Lit q = ps[l];
+                    ps.clear();
+                    propagators[k].prop->explain(*this, q, ps);
+                    confl = propagator_confl = ca.alloc(ps, false);
+                    qhead = trail.size();
+                    break;
+                }
+            }
+        }
     }
     propagations += num_props;
     simpDB_props -= num_props;
@@ -616,31 +857,54 @@ CRef Solver::propagate()
 |  reduceDB : ()  ->  [void]
 |  
 |  Description:
-|    Remove half of the learnt clauses, minus the clauses locked by the current assignment. Locked
-|    clauses are clauses that are reason to some assignment. Binary clauses are never removed.
+|    Remove half of the local learnt clauses, minus the clauses locked by the current assignment.
+|    Locked clauses are clauses that are reason to some assignment. Binary clauses are never removed.
+|
+|    cb_minisat: learnt clauses are kept in tiers by their LBD. Core clauses ('lbd <= core_lbd') are
+|    never removed, tier2 clauses ('lbd <= tier2_lbd') are kept while they take part in conflicts,
+|    and the rest is local: ranked by LBD and then activity, of which the worse half goes.
 |________________________________________________________________________________________________@*/
 struct reduceDB_lt { 
     ClauseAllocator& ca;
     reduceDB_lt(ClauseAllocator& ca_) : ca(ca_) {}
     bool operator () (CRef x, CRef y) { 
-        return ca[x].size() > 2 && (ca[y].size() == 2 || ca[x].activity() < ca[y].activity()); } 
+        if (ca[x].lbd() != ca[y].lbd()) return ca[x].lbd() > ca[y].lbd();
+        return ca[x].activity() < ca[y].activity(); } 
 };
 void Solver::reduceDB()
 {
     int     i, j;
     double  extra_lim = cla_inc / learnts.size();    // Remove any clause below this activity
 
+    // Set the core clauses and the tier2 clauses used since the last reduction aside:
+    for (i = j = core_learnts = 0; i < learnts.size(); i++){
+        Clause& c = ca[learnts[i]];
+        bool    keep = c.lbd() <= (uint32_t)core_lbd || (c.lbd() <= (uint32_t)tier2_lbd && c.used());
+        c.used(false);
+        if (keep){
+            core_learnts += c.lbd() <= (uint32_t)core_lbd;
+            learnts_kept.push(learnts[i]);
+        }else
+            learnts[j++] = learnts[i];
+    }
+    learnts.shrink(i - j);
+
     sort(learnts, reduceDB_lt(ca));
-    // Don't delete binary or locked clauses. From the rest, delete clauses from the first half
+    // Don't delete locked clauses. From the local ones, delete clauses from the first half
     // and clauses with activity smaller than 'extra_lim':
+    int limit = learnts.size() / 2;
     for (i = j = 0; i < learnts.size(); i++){
         Clause& c = ca[learnts[i]];
-        if (c.size() > 2 && !locked(c) && (i < learnts.size() / 2 || c.activity() < extra_lim))
+        if (!locked(c) && (i < limit || c.activity() < extra_lim))
             removeClause(learnts[i]);
         else
             learnts[j++] = learnts[i];
     }
     learnts.shrink(i - j);
+
+    for (i = 0; i < learnts_kept.size(); i++)
+        learnts.push(learnts_kept[i]);
+    learnts_kept.clear();
     checkGarbage();
 }
 
@@ -660,13 +924,40 @@ void Solver::removeSatisfied(vec<CRef>& cs)
                     c[k--] = c[c.size()-1];
                     c.pop();
                 }
-            cs[j++] = cs[i];
+            // cb_minisat: what is left of a clause with two literals becomes an implicit binary.
+            if (c.size() == 2 && (c.learnt() || implicit_bin)){
+                attachBin(c[0], c[1], c.learnt());
+                removeClause(cs[i]);
+            }else
+                cs[j++] = cs[i];
         }
     }
     cs.shrink(i - j);
 }
 
 
+void Solver::removeSatisfiedBin()
+{
+    for (int v = 0; v < nVars(); v++)
+        for (int s = 0; s < 2; s++){
+            Lit p = mkLit(v, s);
+            vec<BinWatcher>& ws = watches_bin[p];
+            int i, j;
+            for (i = j = 0; i < ws.size(); i++){
+                const BinWatcher& w = ws[i];
+                if ((value(p) == l_False || value(w.other) == l_True) && (w.learnt || remove_satisfied)){
+                    // The clause '~p v other' is in two lists, count it from the one of its smaller literal:
+                    if (~p < w.other){
+                        if (w.learnt) num_learnts--, learnts_literals -= 2;
+                        else          num_clauses--, clauses_literals -= 2; }
+                }else
+                    ws[j++] = ws[i];
+            }
+            ws.shrink(i - j);
+        }
+}
+
+
 void Solver::rebuildOrderHeap()
 {
     vec<Var> vs;
@@ -697,6 +988,7 @@ bool Solver::simplify()
 
     // Remove satisfied clauses:
     removeSatisfied(learnts);
+    removeSatisfiedBin();
     if (remove_satisfied){       // Can be turned off.
         removeSatisfied(clauses);
 
@@ -754,6 +1046,10 @@ lbool Solver::search(int nof_conflicts)
     vec<Lit>    learnt_clause;
     starts++;
 
+    // cb_minisat: take in the clauses the other solvers learnt since the last restart.
+    if (exchange != NULL && !importClauses())
+        return l_False;
+
     for (;;){
         CRef confl = propagate();
         if (confl != CRef_Undef){
@@ -761,16 +1057,45 @@ lbool Solver::search(int nof_conflicts)
             conflicts++; conflictC++;
             if (decisionLevel() == 0) return l_False;
 
+            // cb_minisat: a propagator conflict need not involve the current decision level.
+            if (propagator_confl == confl){
+                const Clause& c = ca[confl];
+                int max_level = 0;
+                for (int i = 0; i < c.size(); i++)
+                    if (level(var(c[i])) > max_level)
+                        max_level = level(var(c[i]));
+                if (max_level == 0) return l_False;
+                cancelUntil(max_level);
+            }
+
             learnt_clause.clear();
             analyze(confl, learnt_clause, backtrack_level);
+            int lbd = computeLBD(learnt_clause);
+            if (exchange != NULL)
+                exchange->publish(exchange_id, learnt_clause, lbd);
+
+            // cb_minisat: a trail much longer than usual hints at a model close by, so hold off restarting.
+            sum_lbd += lbd;
+            trail_queue.push(trail.size());
+            if (glucose_restart && conflicts > 10000 && lbd_queue.full() && trail.size() > restart_R * trail_queue.avg())
+                lbd_queue.clear();
+            lbd_queue.push(lbd);
+
             cancelUntil(backtrack_level);
 
             if (learnt_clause.size() == 1){
                 uncheckedEnqueue(learnt_clause[0]);
+            }else if (learnt_clause.size() == 2){
+                // cb_minisat: binary learnts stay implicit, out of 'learnts' and 'reduceDB()':
+                attachBin(learnt_clause[0], learnt_clause[1], true);
+                uncheckedEnqueue(learnt_clause[0], CRef_Bin);
+                vardata[var(learnt_clause[0])].bin = learnt_clause[1];
             }else{
                 CRef cr = ca.alloc(learnt_clause, true);
                 learnts.push(cr);
                 attachClause(cr);
+                ca[cr].lbd(lbd);
+                ca[cr].used(true);
                 claBumpActivity(ca[cr]);
                 uncheckedEnqueue(learnt_clause[0], cr);
             }
@@ -792,9 +1117,14 @@ lbool Solver::search(int nof_conflicts)
 
         }else{
             // NO CONFLICT
-            if ((nof_conflicts >= 0 && conflictC >= nof_conflicts) || !withinBudget()){
+            // cb_minisat: with 'glucose_restart', restart once the recent conflicts learn clauses of a worse
+            // LBD than the average so far.
+            bool lbd_restart = glucose_restart && lbd_queue.full() && lbd_queue.avg() * restart_K > (double)sum_lbd / conflicts;
+            if ((nof_conflicts >= 0 && conflictC >= nof_conflicts) || lbd_restart || !withinBudget()){
                 // Reached bound on number of conflicts:
                 progress_estimate = progressEstimate();
+                if (lbd_restart)
+                    lbd_queue.clear();
                 cancelUntil(0);
                 return l_Undef; }
 
@@ -802,7 +1132,7 @@ lbool Solver::search(int nof_conflicts)
             if (decisionLevel() == 0 && !simplify())
                 return l_False;
 
-            if (learnts.size()-nAssigns() >= max_learnts)
+            if (learnts.size()-core_learnts-nAssigns() >= max_learnts)
                 // Reduce the set of learnt clauses:
                 reduceDB();
 
@@ -827,9 +1157,19 @@ lbool Solver::search(int nof_conflicts)
                 decisions++;
                 next = pickBranchLit();
 
-                if (next == lit_Undef)
+                if (next == lit_Undef){
                     // Model found:
+                    // cb_minisat: remember the decisions behind the model for 'enumNext()'; with a projection,
+                    // the ones that fixed it.
+                    model_decisions.clear();
+                    for (int i = assumptions.size(); i < trail_lim.size(); i++){
+                        Lit d = trail[trail_lim[i]];
+                        if (enum_projected && !priority[var(d)])
+                            break;
+                        model_decisions.push(d);
+                    }
                     return l_True;
+                }
             }
 
             // Increase decision level and enqueue 'next'
@@ -910,7 +1250,7 @@ lbool Solver::solve_()
     int curr_restarts = 0;
     while (status == l_Undef){
         double rest_base = luby_restart ? luby(restart_inc, curr_restarts) : pow(restart_inc, curr_restarts);
-        status = search(rest_base * restart_first);
+        status = search(glucose_restart ? -1 : rest_base * restart_first);
         if (!withinBudget()) break;
         curr_restarts++;
     }
@@ -957,6 +1297,23 @@ bool Solver::implies(const vec<Lit>& assumps, vec<Lit>& out)
     return ret;
 }
 
+
+// cb_minisat: each original binary clause once, from the list of its smaller literal.
+void Solver::binaryClauses(vec<Lit>& out) const
+{
+    out.clear();
+    for (int v = 0; v < nVars(); v++)
+        for (int s = 0; s < 2; s++){
+            Lit p = mkLit(v, s);
+            const vec<BinWatcher>& ws = watches_bin[p];
+            for (int i = 0; i < ws.size(); i++)
+                if (!ws[i].learnt && ~p < ws[i].other){
+                    out.push(~p);
+                    out.push(ws[i].other); }
+        }
+}
+
+
 //=================================================================================================
 // Writing CNF to DIMACS:
 // 
@@ -1001,6 +1358,8 @@ void Solver::toDimacs(FILE* f, const vec<Lit>& assumps)
         return; }
 
     vec<Var> map; Var max = 0;
+    vec<Lit> bins;
+    binaryClauses(bins);
 
     // Cannot use removeClauses here because it is not safe
     // to deallocate them at this point. Could be improved.
@@ -1017,6 +1376,19 @@ void Solver::toDimacs(FILE* f, const vec<Lit>& assumps)
                     mapVar(var(c[j]), map, max);
         }
 
+    // cb_minisat: the implicit binaries, unless satisfied:
+    int j = 0;
+    for (int i = 0; i < bins.size(); i += 2)
+        if (value(bins[i]) != l_True && value(bins[i+1]) != l_True){
+            bins[j++] = bins[i];
+            bins[j++] = bins[i+1];
+            cnt++;
+            for (int k = j-2; k < j; k++)
+                if (value(bins[k]) != l_False)
+                    mapVar(var(bins[k]), map, max);
+        }
+    bins.shrink(bins.size() - j);
+
     // Assumptions are added as unit clauses:
     cnt += assumps.size();
 
@@ -1030,6 +1402,13 @@ void Solver::toDimacs(FILE* f, const vec<Lit>& assumps)
     for (int i = 0; i < clauses.size(); i++)
         toDimacs(f, ca[clauses[i]], map, max);
 
+    for (int i = 0; i < bins.size(); i += 2){
+        for (int k = i; k < i+2; k++)
+            if (value(bins[k]) != l_False)
+                fprintf(f, "%s%d ", sign(bins[k]) ? "-" : "", mapVar(var(bins[k]), map, max)+1);
+        fprintf(f, "0\n");
+    }
+
     if (verbosity > 0)
         printf("Wrote DIMACS with %d variables and %d clauses.\n", max, cnt);
 }
@@ -1072,12 +1451,15 @@ void Solver::relocAll(ClauseAllocator& to)
 
         // Note: it is not safe to call 'locked()' on a relocated clause. This is why we keep
         // 'dangling' reasons here. It is safe and does not hurt.
-        if (reason(v) != CRef_Undef && (ca[reason(v)].reloced() || locked(ca[reason(v)]))){
+        if (reason(v) != CRef_Undef && reason(v) != CRef_Bin && (ca[reason(v)].reloced() || locked(ca[reason(v)]))){
             assert(!isRemoved(reason(v)));
             ca.reloc(vardata[v].reason, to);
         }
     }
 
+    if (propagator_confl != CRef_Undef)
+        ca.reloc(propagator_confl, to);
+
     // All learnt:
     //
     int i, j;
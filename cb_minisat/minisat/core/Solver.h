@@ -25,12 +25,68 @@ OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWA
 #include "minisat/mtl/Heap.h"
 #include "minisat/mtl/Alg.h"
 #include "minisat/mtl/IntMap.h"
+#include "minisat/mtl/Queue.h"
 #include "minisat/utils/Options.h"
 #include "minisat/core/SolverTypes.h"
 
 
 namespace Minisat {
 
+class Solver;
+
+//=================================================================================================
+// Propagator -- cb_minisat plugin interface:
+
+class Propagator {
+public:
+    virtual ~Propagator() {}
+
+    // Called when the positive literal 'p' of a registered variable is propagated, and for negative
+    // literals too if the propagator was attached with 'negative' set. Literals implied
+    // by 'p' are pushed to 'out', a reusable buffer that the solver clears before the call. Literals
+    // that are already true should not be pushed. Returns false on a conflict, in which case 'out'
+    // holds a clause whose literals are all false.
+    virtual bool propagate (const Solver& solver, Lit p, vec<Lit>& out) = 0;
+
+    // Called lazily by conflict analysis for a literal 'p' implied by this propagator (or pushed by
+    // it while already false). Fills 'out' with the reason clause: 'p' first, followed by literals
+    // that are false and were assigned before 'p' was implied.
+    virtual void explain (const Solver& solver, Lit p, vec<Lit>& out) = 0;
+
+    // The solver has backtracked to decision level 'level'.
+    virtual void backtrack (const Solver& solver, int level) {}
+};
+
+
+//=================================================================================================
+// Brancher -- cb_minisat plugin interface for the decision heuristic:
+
+class Brancher {
+public:
+    virtual ~Brancher() {}
+
+    // Called before every decision. Returns an unassigned literal to branch on, or lit_Undef to
+    // leave the decision to the activity heuristic.
+    virtual Lit decide (const Solver& solver) = 0;
+};
+
+
+//=================================================================================================
+// ClauseExchange -- cb_minisat learnt clause sharing between solvers over the same variables:
+
+class ClauseExchange {
+public:
+    virtual ~ClauseExchange() {}
+
+    // Offers a clause learnt by solver 'id', with its literal block distance 'lbd', to the others.
+    virtual void publish (int id, const vec<Lit>& clause, int lbd) = 0;
+
+    // Moves the next clause published by another solver into 'out'. Returns false when there is
+    // none left for solver 'id'.
+    virtual bool fetch (int id, vec<Lit>& out) = 0;
+};
+
+
 //=================================================================================================
 // Solver -- the main class:
 
@@ -44,7 +100,7 @@ public:
 
     // Problem specification:
     //
-    Var     newVar    (lbool upol = l_Undef, bool dvar = true); // Add a new variable with parameters specifying variable mode.
+    virtual Var newVar(lbool upol = l_Undef, bool dvar = true); // Add a new variable with parameters specifying variable mode.
     void    releaseVar(Lit l);                                  // Make literal true and promise to never refer to variable again.
 
     bool    addClause (const vec<Lit>& ps);                     // Add a clause to the solver. 
@@ -53,7 +109,7 @@ public:
     bool    addClause (Lit p, Lit q);                           // Add a binary clause to the solver. 
     bool    addClause (Lit p, Lit q, Lit r);                    // Add a ternary clause to the solver. 
     bool    addClause (Lit p, Lit q, Lit r, Lit s);             // Add a quaternary clause to the solver. 
-    bool    addClause_(      vec<Lit>& ps);                     // Add a clause to the solver without making superflous internal copy. Will
+    virtual bool addClause_(vec<Lit>& ps);                      // Add a clause to the solver without making superflous internal copy. Will
                                                                 // change the passed vector 'ps'.
 
     // Solving:
@@ -69,11 +125,23 @@ public:
 
     bool    implies      (const vec<Lit>& assumps, vec<Lit>& out);
 
+    // cb_minisat: all-solutions search without blocking clauses. The search space is split by the
+    // decisions behind each model, DPLL style, and only the decision variables tell models apart.
+    //
+    void    enumStart    (const vec<Lit>& assumps); // Start enumerating the models that respect 'assumps'.
+    void    enumStart    (const vec<Lit>& assumps, const vec<Var>& projection);
+                                                    // Same, but models that agree on 'projection' count once. Those
+                                                    // variables are decided first from now on.
+    lbool   enumNext     ();                        // Next model in 'model' (l_True), l_False when there are no more,
+                                                    // l_Undef when a budget ran out (the next call resumes).
+
     // Iterate over clauses and top-level assignments:
     ClauseIterator clausesBegin() const;
     ClauseIterator clausesEnd()   const;
     TrailIterator  trailBegin()   const;
     TrailIterator  trailEnd  ()   const;
+    void           binaryClauses(vec<Lit>& out) const; // cb_minisat: the original binary clauses, two literals each. The
+                                                       // iterators above only see the clauses in 'ca'.
 
     void    toDimacs     (FILE* f, const vec<Lit>& assumps);            // Write CNF to file in DIMACS-format.
     void    toDimacs     (const char *file, const vec<Lit>& assumps);
@@ -89,6 +157,9 @@ public:
     // 
     void    setPolarity    (Var v, lbool b); // Declare which polarity the decision heuristic should use for a variable. Requires mode 'polarity_user'.
     void    setDecisionVar (Var v, bool b);  // Declare if a variable should be eligible for selection in the decision heuristic.
+    bool    isDecisionVar  (Var v) const;    // TRUE if a variable is eligible for selection in the decision heuristic.
+    void    setPhase       (Var v, bool b);  // Preset the saved phase of a variable, until phase saving overwrites it.
+    void    bumpVar        (Var v);          // Move a variable up in the decision order.
 
     // Read state:
     //
@@ -96,6 +167,7 @@ public:
     lbool   value      (Lit p) const;       // The current value of a literal.
     lbool   modelValue (Var x) const;       // The value of a variable in the last model. The last call to solve must have been satisfiable.
     lbool   modelValue (Lit p) const;       // The value of a literal in the last model. The last call to solve must have been satisfiable.
+    int     decisionLevel ()   const;       // Gives the current decisionlevel.
     int     nAssigns   ()      const;       // The current number of assigned literals.
     int     nClauses   ()      const;       // The current number of original clauses.
     int     nLearnts   ()      const;       // The current number of learnt clauses.
@@ -146,6 +218,14 @@ public:
     int       learntsize_adjust_start_confl;
     double    learntsize_adjust_inc;
 
+    // cb_minisat: LBD based restarts and learnt clause tiers.
+    //
+    bool      glucose_restart;    // Restart when the recent LBDs are worse than the average, instead of 'luby_restart'.
+    double    restart_K;          // Restart when the average of the last 50 LBDs times K exceeds the global average.    (default 0.8)
+    double    restart_R;          // Postpone restarts when the trail is R times longer than the recent average.        (default 1.4)
+    int       core_lbd;           // Learnt clauses up to this LBD are never removed by 'reduceDB()'.                   (default 2)
+    int       tier2_lbd;          // Learnt clauses up to this LBD are kept as long as they are used between reductions. (default 6)
+
     // Statistics: (read-only member variable)
     //
     uint64_t solves, starts, decisions, rnd_decisions, propagations, conflicts;
@@ -153,20 +233,34 @@ public:
 
     /*****************************************************************************
      * cb_minisat
-     * @brief	
+     * @brief       'prop' is notified of positive assignments of the variables first..last,
+     *              and of negative ones as well if 'negative'
+     * @version						v0.01b
+     ****************************************************************************/
+    void    attachPropagator (Propagator* prop, Var first, Var last, bool negative = false);
+
+    /*****************************************************************************
+     * cb_minisat
+     * @brief       learnt clauses are published to 'x' as solver 'id', and clauses of
+     *              the other solvers are imported at restarts; NULL detaches
      * @version						v0.01b
      ****************************************************************************/
+    void    attachExchange (ClauseExchange* x, int id);
 
-    void*        callback_obj_pt;
-    static void  callback_nop  (void* _object_pointer, const VMap<lbool> &assigns, const vec<Lit>& trail, vec<Lit>& ps) {}
-    void       (*callback)     (void* object_pointer, const VMap<lbool> &assigns, const vec<Lit>& trail, vec<Lit>& ps);
+    /*****************************************************************************
+     * cb_minisat
+     * @brief       'b' is asked for every decision before the activity heuristic
+     * @version						v0.01b
+     ****************************************************************************/
+    void    attachBrancher (Brancher* b);
 
 protected:
 
     // Helper structures:
     //
-    struct VarData { CRef reason; int level; Lit cb_reason;};
-    static inline VarData mkVarData(CRef cr, int l, Lit cbr = lit_Undef){ VarData d = {cr, l, cbr}; return d; }
+    struct VarData { CRef reason; int level; int prop; Lit bin; };   // 'prop' indexes 'propagators' for literals they implied,
+                                                                      // 'bin' is the other literal of a 'CRef_Bin' reason
+    static inline VarData mkVarData(CRef cr, int l, int prop = -1){ VarData d = {cr, l, prop, lit_Undef}; return d; }
 
     struct Watcher {
         CRef cref;
@@ -176,6 +270,12 @@ protected:
         bool operator!=(const Watcher& w) const { return cref != w.cref; }
     };
 
+    struct BinWatcher {
+        Lit  other;
+        bool learnt;
+        BinWatcher(Lit p, bool l) : other(p), learnt(l) {}
+    };
+
     struct WatcherDeleted
     {
         const ClauseAllocator& ca;
@@ -185,8 +285,16 @@ protected:
 
     struct VarOrderLt {
         const IntMap<Var, double>&  activity;
-        bool operator () (Var x, Var y) const { return activity[x] > activity[y]; }
-        VarOrderLt(const IntMap<Var, double>&  act) : activity(act) { }
+        const IntMap<Var, char>&    priority;
+        bool operator () (Var x, Var y) const {
+            return priority[x] != priority[y] ? priority[x] > priority[y] : activity[x] > activity[y]; }
+        VarOrderLt(const IntMap<Var, double>&  act, const IntMap<Var, char>& prio) : activity(act), priority(prio) { }
+    };
+
+    struct PropagatorRef {
+        Propagator* prop;
+        Var         first, last;
+        bool        negative;
     };
 
     struct ShrinkStackElem {
@@ -208,9 +316,12 @@ protected:
     VMap<char>          polarity;         // The preferred polarity of each variable.
     VMap<lbool>         user_pol;         // The users preferred polarity of each variable.
     VMap<char>          decision;         // Declares if a variable is eligible for selection in the decision heuristic.
+    VMap<char>          priority;         // cb_minisat: variables of the enumeration projection, decided before the others.
     VMap<VarData>       vardata;          // Stores reason and level for each variable.
     OccLists<Lit, vec<Watcher>, WatcherDeleted, MkIndexLit>
                         watches;          // 'watches[lit]' is a list of constraints watching 'lit' (will go there if literal becomes true).
+    LMap<vec<BinWatcher> >
+                        watches_bin;      // cb_minisat: implicit binary clauses, 'watches_bin[lit]' lists the literals implied when 'lit' becomes true.
 
     Heap<Var,VarOrderLt>order_heap;       // A priority queue of variables ordered with respect to the variable activity.
 
@@ -222,12 +333,20 @@ protected:
     int64_t             simpDB_props;     // Remaining number of propagations that must be made before next execution of 'simplify()'.
     double              progress_estimate;// Set by 'search()'.
     bool                remove_satisfied; // Indicates whether possibly inefficient linear scan for satisfied clauses should be performed in 'simplify'.
+    bool                implicit_bin;     // cb_minisat: original binary clauses go to 'watches_bin' only. SimpSolver needs them in 'ca' while it eliminates.
     Var                 next_var;         // Next variable to be created.
     ClauseAllocator     ca;
 
     vec<Var>            released_vars;
     vec<Var>            free_vars;
 
+    vec<PropagatorRef>  propagators;      // cb_minisat plugins and the variable ranges they watch.
+    CRef                propagator_confl; // Conflict clause built from a propagator, freed on the next 'propagate()'.
+    Lit                 bin_confl[2];     // cb_minisat: the implicit binary behind 'CRef_Bin' in 'analyze()', the conflict and then the reasons.
+    ClauseExchange*     exchange;         // Learnt clause sharing, or NULL.
+    Brancher*           brancher;         // Decision heuristic plugin, or NULL.
+    int                 exchange_id;      // This solver's id in 'exchange'.
+
     // Temporaries (to reduce allocation overhead). Each variable is prefixed by the method in which it is
     // used, exept 'seen' wich is used in several places.
     //
@@ -235,6 +354,24 @@ protected:
     vec<ShrinkStackElem>analyze_stack;
     vec<Lit>            analyze_toclear;
     vec<Lit>            add_tmp;
+    vec<Lit>            propagator_tmp;
+    vec<Lit>            exchange_tmp;
+    vec<CRef>           learnts_kept;
+
+    vec<Lit>            model_decisions;  // cb_minisat: decisions above the assumption levels behind the last model.
+    vec<Lit>            enum_path;        // cb_minisat: assumptions of the subspace 'enumNext()' searches next.
+    vec<char>           enum_flipped;     // cb_minisat: TRUE if 'enum_path[i]' is a flipped decision, its other branch is done.
+    int                 enum_base;        // cb_minisat: the user assumptions at the bottom of 'enum_path'.
+    vec<Var>            enum_projection;  // cb_minisat: the variables with 'priority' set.
+    bool                enum_projected;   // cb_minisat: TRUE if 'enumNext()' tells models apart by 'enum_projection' only.
+    bool                enum_done;
+    vec<int>            lbd_seen;
+    int                 lbd_stamp;
+
+    BoundedQueue<int>   lbd_queue;        // cb_minisat: LBDs of the last conflicts, for 'glucose_restart'.
+    BoundedQueue<int>   trail_queue;      // cb_minisat: trail sizes at the last conflicts, for blocking restarts.
+    uint64_t            sum_lbd;          // cb_minisat: sum of the LBDs of all learnt clauses.
+    int                 core_learnts;     // cb_minisat: learnt clauses kept for good by the last 'reduceDB()'.
 
     double              max_learnts;
     double              learntsize_adjust_confl;
@@ -244,7 +381,7 @@ protected:
     //
     int64_t             conflict_budget;    // -1 means no budget.
     int64_t             propagation_budget; // -1 means no budget.
-    bool                asynch_interrupt;
+    volatile bool       asynch_interrupt;
 
     // Main internal methods:
     //
@@ -258,10 +395,15 @@ protected:
     void     analyze          (CRef confl, vec<Lit>& out_learnt, int& out_btlevel);    // (bt = backtrack)
     void     analyzeFinal     (Lit p, LSet& out_conflict);                             // COULD THIS BE IMPLEMENTED BY THE ORDINARIY "analyze" BY SOME REASONABLE GENERALIZATION?
     bool     litRedundant     (Lit p);                                                 // (helper method for 'analyze()')
+    template<class C>
+    int      computeLBD       (const C& c);                                            // Number of distinct decision levels in 'c'.
+    bool     importClauses    ();                                                      // Add the clauses waiting in 'exchange' at level 0.
     lbool    search           (int nof_conflicts);                                     // Search for a given number of conflicts.
     lbool    solve_           ();                                                      // Main solve method (assumptions given in 'assumptions').
+    virtual lbool enumSolve   () { return solve_(); }                                  // 'solve_()' for 'enumNext()', with model extension in SimpSolver.
     void     reduceDB         ();                                                      // Reduce the set of learnt clauses.
     void     removeSatisfied  (vec<CRef>& cs);                                         // Shrink 'cs' to contain only non-satisfied clauses.
+    void     removeSatisfiedBin();                                                     // The same for the implicit binary clauses.
     void     rebuildOrderHeap ();
 
     // Maintaining Variable/Clause activity:
@@ -275,6 +417,7 @@ protected:
     // Operations on clauses:
     //
     void     attachClause     (CRef cr);               // Attach a clause to watcher lists.
+    void     attachBin        (Lit p, Lit q, bool learnt); // cb_minisat: add the implicit binary clause 'p v q'.
     void     detachClause     (CRef cr, bool strict = false); // Detach a clause to watcher lists.
     void     removeClause     (CRef cr);               // Detach and free a clause.
     bool     isRemoved        (CRef cr) const;         // Test if a clause has been removed.
@@ -283,11 +426,10 @@ protected:
 
     // Misc:
     //
-    int      decisionLevel    ()      const; // Gives the current decisionlevel.
     uint32_t abstractLevel    (Var x) const; // Used to represent an abstraction of sets of decision levels.
     CRef     reason           (Var x) const;
+    CRef     lazyReason       (Var x);       // Like 'reason()', asks the implying propagator for a clause if needed.
     int      level            (Var x) const;
-    bool     cb_child         (Var x) const;
     double   progressEstimate ()      const; // DELETE THIS ?? IT'S NOT VERY USEFUL ...
     bool     withinBudget     ()      const;
     void     relocAll         (ClauseAllocator& to);
@@ -313,7 +455,14 @@ protected:
 
 inline CRef  Solver::reason    (Var x) const { return vardata[x].reason; }
 inline int   Solver::level     (Var x) const { return vardata[x].level; }
-inline bool  Solver::cb_child  (Var x) const { return vardata[x].cb_reason != lit_Undef; }
+inline CRef  Solver::lazyReason(Var x) {
+    if (vardata[x].reason == CRef_Undef && vardata[x].prop >= 0){
+        Lit p = mkLit(x, value(x) == l_False);
+        add_tmp.clear();
+        propagators[vardata[x].prop].prop->explain(*this, p, add_tmp);
+        assert(add_tmp[0] == p);
+        vardata[x].reason = ca.alloc(add_tmp, false); }
+    return vardata[x].reason; }
 
 inline void Solver::insertVarOrder(Var x) {
     if (!order_heap.inHeap(x) && decision[x]) order_heap.insert(x); }
@@ -354,7 +503,24 @@ inline bool     Solver::addClause       (Lit p, Lit q, Lit r)   { add_tmp.clear(
 inline bool     Solver::addClause       (Lit p, Lit q, Lit r, Lit s){ add_tmp.clear(); add_tmp.push(p); add_tmp.push(q); add_tmp.push(r); add_tmp.push(s); return addClause_(add_tmp); }
 
 inline bool     Solver::isRemoved       (CRef cr)         const { return ca[cr].mark() == 1; }
-inline bool     Solver::locked          (const Clause& c) const { return value(c[0]) == l_True && reason(var(c[0])) != CRef_Undef && ca.lea(reason(var(c[0]))) == &c; }
+inline bool     Solver::locked          (const Clause& c) const { CRef r = reason(var(c[0])); return value(c[0]) == l_True && r != CRef_Undef && r != CRef_Bin && ca.lea(r) == &c; }
+
+template<class C>
+inline int Solver::computeLBD(const C& c)
+{
+    if (lbd_seen.size() <= decisionLevel())
+        lbd_seen.growTo(decisionLevel() + 1, 0);
+    lbd_stamp++;
+
+    int lbd = 0;
+    for (int i = 0; i < c.size(); i++){
+        int l = level(var(c[i]));
+        if (lbd_seen[l] != lbd_stamp){
+            lbd_seen[l] = lbd_stamp;
+            lbd++; }
+    }
+    return lbd;
+}
 inline void     Solver::newDecisionLevel()                      { trail_lim.push(trail.size()); }
 
 inline int      Solver::decisionLevel ()      const   { return trail_lim.size(); }
@@ -370,6 +536,9 @@ inline int      Solver::nVars         ()      const   { return next_var; }
 // TODO: nFreeVars() is not quite correct, try to calculate right instead of adapting it like below:
 inline int      Solver::nFreeVars     ()      const   { return (int)dec_vars - (trail_lim.size() == 0 ? trail.size() : trail_lim[0]); }
 inline void     Solver::setPolarity   (Var v, lbool b){ user_pol[v] = b; }
+inline bool     Solver::isDecisionVar (Var v) const { return decision[v]; }
+inline void     Solver::setPhase      (Var v, bool b) { polarity[v] = !b; }
+inline void     Solver::bumpVar       (Var v) { varBumpActivity(v); }
 inline void     Solver::setDecisionVar(Var v, bool b) 
 { 
     if      ( b && !decision[v]) dec_vars++;
@@ -399,8 +568,9 @@ inline bool     Solver::solve         (const vec<Lit>& assumps){ budgetOff(); as
 inline lbool    Solver::solveLimited  (const vec<Lit>& assumps){ assumps.copyTo(assumptions); return solve_(); }
 inline bool     Solver::okay          ()      const   { return ok; }
 
-inline ClauseIterator Solver::clausesBegin() const { return ClauseIterator(ca, &clauses[0]); }
-inline ClauseIterator Solver::clausesEnd  () const { return ClauseIterator(ca, &clauses[clauses.size()]); }
+// (with the binaries implicit, 'clauses' may well be empty and have no storage at all)
+inline ClauseIterator Solver::clausesBegin() const { return ClauseIterator(ca, clauses.size() == 0 ? NULL : &clauses[0]); }
+inline ClauseIterator Solver::clausesEnd  () const { return ClauseIterator(ca, clauses.size() == 0 ? NULL : &clauses[clauses.size()]); }
 inline TrailIterator  Solver::trailBegin  () const { return TrailIterator(&trail[0]); }
 inline TrailIterator  Solver::trailEnd    () const { 
     return TrailIterator(&trail[decisionLevel() == 0 ? trail.size() : trail_lim[0]]); }
@@ -160,9 +160,10 @@ class Clause {
             data[i].lit = ps[i];
 
         if (header.has_extra){
-            if (header.learnt)
-                data[header.size].act = 0;
-            else
+            if (header.learnt){
+                data[header.size].act     = 0;
+                data[header.size + 1].abs = 0;
+            }else
                 calcAbstraction();
     }
     }
@@ -176,9 +177,10 @@ class Clause {
             data[i].lit = from[i];
 
         if (header.has_extra){
-            if (header.learnt)
-                data[header.size].act = from.data[header.size].act;
-            else 
+            if (header.learnt){
+                data[header.size].act     = from.data[header.size].act;
+                data[header.size + 1].abs = from.data[header.size + 1].abs;
+            }else 
                 data[header.size].abs = from.data[header.size].abs;
     }
     }
@@ -193,7 +195,10 @@ public:
 
 
     int          size        ()      const   { return header.size; }
-    void         shrink      (int i)         { assert(i <= size()); if (header.has_extra) data[header.size-i] = data[header.size]; header.size -= i; }
+    void         shrink      (int i)         { assert(i <= size());
+                                               if (header.has_extra) data[header.size-i] = data[header.size];
+                                               if (header.learnt) data[header.size-i+1] = data[header.size+1];
+                                               header.size -= i; }
     void         pop         ()              { shrink(1); }
     bool         learnt      ()      const   { return header.learnt; }
     bool         has_extra   ()      const   { return header.has_extra; }
@@ -205,6 +210,14 @@ public:
     CRef         relocation  ()      const   { return data[0].rel; }
     void         relocate    (CRef c)        { header.reloced = 1; data[0].rel = c; }
 
+    // cb_minisat: literal block distance of a learnt clause, and whether it took part in conflict
+    // analysis since the last 'reduceDB()'. Kept in a second extra word of learnt clauses
+    // (lbd << 1 | used), so the header of every clause stays one word.
+    uint32_t     lbd         ()      const   { assert(header.learnt); return data[header.size + 1].abs >> 1; }
+    void         lbd         (uint32_t l)    { assert(header.learnt); uint32_t& w = data[header.size + 1].abs; w = (l << 1) | (w & 1); }
+    bool         used        ()      const   { assert(header.learnt); return data[header.size + 1].abs & 1; }
+    void         used        (bool u)        { assert(header.learnt); uint32_t& w = data[header.size + 1].abs; w = (w & ~1u) | (uint32_t)u; }
+
     // NOTE: somewhat unsafe to change the clause in-place! Must manually call 'calcAbstraction' afterwards for
     //       subsumption operations to behave correctly.
     Lit&         operator [] (int i)         { return data[i].lit; }
@@ -223,12 +236,14 @@ public:
 // ClauseAllocator -- a simple class for allocating memory for clauses:
 
 const CRef CRef_Undef = RegionAllocator<uint32_t>::Ref_Undef;
+const CRef CRef_Bin   = CRef_Undef - 1; // cb_minisat: reason or conflict of an implicit binary clause, which has no place in 'ca'.
 class ClauseAllocator
 {
     RegionAllocator<uint32_t> ra;
 
-    static uint32_t clauseWord32Size(int size, bool has_extra){
-        return (sizeof(Clause) + (sizeof(Lit) * (size + (int)has_extra))) / sizeof(uint32_t); }
+    // cb_minisat: learnt clauses always have the extra field and one more word for 'lbd()'/'used()'.
+    static uint32_t clauseWord32Size(int size, bool has_extra, bool learnt){
+        return (sizeof(Clause) + (sizeof(Lit) * (size + (int)has_extra + (int)learnt))) / sizeof(uint32_t); }
 
  public:
     enum { Unit_Size = RegionAllocator<uint32_t>::Unit_Size };
@@ -247,7 +262,7 @@ class ClauseAllocator
         assert(sizeof(Lit)      == sizeof(uint32_t));
         assert(sizeof(float)    == sizeof(uint32_t));
         bool use_extra = learnt | extra_clause_field;
-        CRef cid       = ra.alloc(clauseWord32Size(ps.size(), use_extra));
+        CRef cid       = ra.alloc(clauseWord32Size(ps.size(), use_extra, learnt));
         new (lea(cid)) Clause(ps, use_extra, learnt);
 
         return cid;
@@ -256,7 +271,7 @@ class ClauseAllocator
     CRef alloc(const Clause& from)
     {
         bool use_extra = from.learnt() | extra_clause_field;
-        CRef cid       = ra.alloc(clauseWord32Size(from.size(), use_extra));
+        CRef cid       = ra.alloc(clauseWord32Size(from.size(), use_extra, from.learnt()));
         new (lea(cid)) Clause(from, use_extra);
         return cid; }
 
@@ -273,7 +288,7 @@ class ClauseAllocator
     void free(CRef cid)
     {
         Clause& c = operator[](cid);
-        ra.free(clauseWord32Size(c.size(), c.has_extra()));
+        ra.free(clauseWord32Size(c.size(), c.has_extra(), c.learnt()));
     }
 
     void reloc(CRef& cr, ClauseAllocator& to)
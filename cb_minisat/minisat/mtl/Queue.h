@@ -63,6 +63,38 @@ public:
 };
 
 
+//=================================================================================================
+// BoundedQueue -- cb_minisat: the last 'max' values pushed, with their running sum:
+
+template<class T>
+class BoundedQueue {
+    vec<T>  buf;
+    int     first;
+    int     count;
+    int64_t sum;
+
+public:
+    BoundedQueue() : first(0), count(0), sum(0) {}
+
+    void   init  (int max) { buf.clear(); buf.growTo(max); first = count = 0; sum = 0; }
+    void   clear ()        { first = count = 0; sum = 0; }
+    bool   full  () const  { return count == buf.size(); }
+    int    size  () const  { return count; }
+    double avg   () const  { assert(count > 0); return (double)sum / count; }
+
+    void push(T elem) {
+        assert(buf.size() > 0);
+        if (full()){
+            sum -= buf[first];
+            buf[first++] = elem;
+            if (first == buf.size()) first = 0;
+        }else
+            buf[(first + count++) % buf.size()] = elem;
+        sum += elem;
+    }
+};
+
+
 //=================================================================================================
 }
 
@@ -66,6 +66,7 @@ SimpSolver::SimpSolver() :
     ca.extra_clause_field = true; // NOTE: must happen before allocating the dummy clause below.
     bwdsub_tmpunit        = ca.alloc(dummy);
     remove_satisfied      = false;
+    implicit_bin          = false;
 }
 
 
@@ -538,6 +539,8 @@ bool SimpSolver::eliminateVar(Var v)
     // Free watchers lists for this variable, if possible:
     if (watches[ mkLit(v)].size() == 0) watches[ mkLit(v)].clear(true);
     if (watches[~mkLit(v)].size() == 0) watches[~mkLit(v)].clear(true);
+    if (watches_bin[ mkLit(v)].size() == 0) watches_bin[ mkLit(v)].clear(true);
+    if (watches_bin[~mkLit(v)].size() == 0) watches_bin[~mkLit(v)].clear(true);
 
     return backwardSubsumptionCheck();
 }
@@ -658,12 +661,18 @@ bool SimpSolver::eliminate(bool turn_off_elim)
 
         use_simplification    = false;
         remove_satisfied      = true;
+        implicit_bin          = true;
         ca.extra_clause_field = false;
         max_simp_var          = nVars();
 
         // Force full cleanup (this is safe and desirable since it only happens once):
         rebuildOrderHeap();
         garbageCollect();
+
+        // The binary clauses left can go to 'watches_bin' now ('clauses' holds no removed ones after
+        // the collection):
+        if (ok)
+            removeSatisfied(clauses);
     }else{
         // Cheaper cleanup:
         checkGarbage();
@@ -154,6 +154,7 @@ class SimpSolver : public Solver {
     // Main internal methods:
     //
     lbool         solve_                   (bool do_simp = true, bool turn_off_simp = false);
+    lbool         enumSolve                () { return solve_(); }
     bool          asymm                    (Var v, CRef cr);
     bool          asymmVar                 (Var v);
     void          updateElimHeap           (Var v);
@@ -28,9 +28,19 @@
 #include <sstream>
 #include <vector>
 #include <algorithm>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
 #include <igraph/igraph.h>
 
 #include "formula.hpp"
+#include "minisat/simp/SimpSolver.h"
 
 
 /********************************************************************************
@@ -72,7 +82,8 @@ int igraph_test_isomorphic_map (const igraph_t *graph1, const igraph_t *graph2,
           const igraph_vector_t *map21,
           igraph_isocompat_t *node_compat_fn,
           igraph_isocompat_t *edge_compat_fn,
-          void *arg);
+          void *arg,
+          igraph_bool_t induced = false);
 
 
 // see cpp file for documentation
@@ -86,6 +97,22 @@ int igraph_subisomorphic_sat (const igraph_t *graph1, const igraph_t *graph2,
           igraph_vector_t *map21,
           igraph_isocompat_t *node_compat_fn,
           igraph_isocompat_t *edge_compat_fn,
+          void *arg,
+          igraph_bool_t induced = false,
+          igraph_integer_t threads = 1,
+          igraph_bool_t cubes = false);
+
+
+// see cpp file for documentation
+int igraph_homomorphic_sat (const igraph_t *graph1, const igraph_t *graph2, 
+          const igraph_vector_int_t *vertex_colour1,
+          const igraph_vector_int_t *vertex_colour2,
+          const igraph_vector_int_t *edge_colour1,
+          const igraph_vector_int_t *edge_colour2,
+          igraph_bool_t *hom,
+          igraph_vector_t *map21,
+          igraph_isocompat_t *node_compat_fn,
+          igraph_isocompat_t *edge_compat_fn,
           void *arg);
 
 
@@ -100,7 +127,10 @@ int igraph_get_subisomorphisms_sat (const igraph_t *graph1, const igraph_t *grap
           igraph_vector_t *map21,
           igraph_isocompat_t *node_compat_fn,
           igraph_isocompat_t *edge_compat_fn,
-          void *arg);
+          void *arg,
+          igraph_bool_t induced = false,
+          igraph_integer_t max_maps = -1,
+          igraph_bool_t *reached = NULL);
 
 
 // see cpp file for documentation
@@ -112,7 +142,43 @@ int igraph_count_subisomorphisms_sat (const igraph_t *graph1, const igraph_t *gr
           igraph_integer_t *count,
           igraph_isocompat_t *node_compat_fn,
           igraph_isocompat_t *edge_compat_fn,
-          void *arg);
+          void *arg,
+          igraph_bool_t induced = false,
+          igraph_integer_t threads = 1,
+          igraph_integer_t threshold = -1,
+          igraph_bool_t *reached = NULL);
+
+
+// see cpp file for documentation
+int igraph_count_subisomorphisms_projected_sat (const igraph_t *graph1, const igraph_t *graph2, 
+          const igraph_vector_int_t *vertex_colour1,
+          const igraph_vector_int_t *vertex_colour2,
+          const igraph_vector_int_t *edge_colour1,
+          const igraph_vector_int_t *edge_colour2,
+          const igraph_vector_t *vids2,
+          igraph_integer_t *count,
+          igraph_isocompat_t *node_compat_fn,
+          igraph_isocompat_t *edge_compat_fn,
+          void *arg,
+          igraph_bool_t induced = false,
+          igraph_integer_t threshold = -1,
+          igraph_bool_t *reached = NULL);
+
+
+// see cpp file for documentation
+int igraph_get_subisomorphisms_projected_sat (const igraph_t *graph1, const igraph_t *graph2, 
+          const igraph_vector_int_t *vertex_colour1,
+          const igraph_vector_int_t *vertex_colour2,
+          const igraph_vector_int_t *edge_colour1,
+          const igraph_vector_int_t *edge_colour2,
+          const igraph_vector_t *vids2,
+          igraph_vector_ptr_t *maps,
+          igraph_isocompat_t *node_compat_fn,
+          igraph_isocompat_t *edge_compat_fn,
+          void *arg,
+          igraph_bool_t induced = false,
+          igraph_integer_t max_maps = -1,
+          igraph_bool_t *reached = NULL);
 
 
 // see cpp file for documentation
@@ -126,7 +192,10 @@ int igraph_subisomorphic_function_sat (const igraph_t *graph1, const igraph_t *g
           igraph_isohandler_t *isohandler_fn,
           igraph_isocompat_t *node_compat_fn,
           igraph_isocompat_t *edge_compat_fn,
-          void *arg);
+          void *arg,
+          igraph_bool_t induced = false,
+          igraph_integer_t max_maps = -1,
+          igraph_bool_t *reached = NULL);
 
 
 
@@ -140,6 +209,14 @@ using namespace Minisat;
 using namespace std;
 
 struct M21;
+struct Adjacency;
+struct NbrProfile;
+struct IsosatOpts;
+class AllDifferent;
+class NonEdges;
+class ForwardCheck;
+class ClauseRing;
+class FailFirst;
 class Isosat;
 
 string str (const M21 &lit);
@@ -155,24 +232,315 @@ struct M21 {
 };
 
 
+// Compressed adjacency lists: the neighbours of vid are nbr[begin[vid] .. begin[vid+1]-1],
+// reached through the edges eid[...]. Undirected graphs list both orientations.
+struct Adjacency {
+    vector<int> begin, nbr, eid;
+    void init (const igraph_t *graph, igraph_neimode_t mode);
+    int  degree (int vid) const { return begin[vid+1] - begin[vid]; };
+};
+
+
+// Distinct-neighbour degree and neighbour colour histogram of every vertex, for one direction.
+// The histogram of vid is colour/count[begin[vid] .. begin[vid+1]-1], sorted by colour.
+struct NbrProfile {
+    vector<int> degree;
+    vector<int> begin, colour, count;
+    void init (const Adjacency &adj, const igraph_vector_int_t *vertex_colour);
+    bool dominates (int vid1, const NbrProfile &pattern, int vid2) const;
+};
+
+
+enum { ENC_SUPPORT, ENC_TSEITIN };
+
+struct IsosatOpts {
+    bool sparse;                        // only create variables for compatible (vid2, vid1) pairs
+    int  edge_encoding;                 // ENC_SUPPORT: M(u2,u1) -> OR M(v2,v1) over neighbours v1 of u1
+                                        // ENC_TSEITIN: OR of matching edge pairs through formula::Formula
+    bool degree_filter;                 // drop pairs whose target in/out degree or neighbour colour
+                                        // histogram does not dominate the pattern's
+    bool refine;                        // iterate neighbourhood refinement of the domains to a fixpoint
+    int  threads;                       // worker threads for the preprocessing stages and the portfolio,
+                                        // node_compat_fn must be thread-safe when > 1
+    bool matching;                      // bipartite matching (Regin) filtering of the injectivity
+    bool induced;                       // pattern non-edges must map to target non-edges
+    bool homomorphism;                  // drop injectivity, pattern vertices may share a target
+    bool symmetry;                      // one embedding per class under pattern automorphisms,
+                                        // ignored with compat functions or homomorphisms
+    bool forward_check;                 // bitset domains of the pattern neighbours are cut down to
+                                        // the target neighbourhood of each true pair
+    bool share;                         // parallel workers exchange short learnt clauses
+    bool fail_first;                    // branch on the unplaced pattern vertex with the fewest open
+                                        // candidates, and only on mapping variables
+    bool greedy_start;                  // hint the first descent with a greedy degree-based mapping
+    bool simplify;                      // variable elimination and subsumption once the encoding is
+                                        // built, the mapping variables are frozen
+    IsosatOpts () : sparse(true), edge_encoding(ENC_SUPPORT), degree_filter(true),
+                    refine(false), threads(1), matching(true), induced(false),
+                    homomorphism(false), symmetry(false), forward_check(false),
+                    share(true), fail_first(false), greedy_start(false), simplify(false) {};
+};
+
+
+// Injectivity of the mapping as an AllDifferent constraint over the pattern vertices.
+// A true M(vid2,vid1) falsifies the rest of the candidate row of vid2 and the rest of the
+// column of vid1. With matching filtering a matching of every pattern vertex is kept, and
+// pairs that lie in no such matching are pruned, each explained by the Hall set forcing it.
+// Reasons are only built when conflict analysis asks for them. Without injectivity only the
+// rows are kept, so that the mapping stays a function (homomorphisms).
+class AllDifferent : public Propagator {
+    private:
+        const Isosat &isosat;
+        bool injective;
+        bool matching;
+
+        vector<int> reason_of;          // var -> true var that falsified it, -(event+1) for a Hall set
+        vector<int> hall_level;         // Hall events, stacked by decision level
+        vector<int> hall_begin;         // event -> offset into hall_lits
+        vector<Lit> hall_lits;          // false literals keeping each Hall set closed
+
+        vector<int> mate2;              // vid2 -> matched variable, -1 if free
+        vector<int> mate1;              // vid1 -> matched vid2, -1 if free
+        vector<int> visit1;             // vid1 -> stamp of the last search that reached it
+        vector<int> visit2;             // vid2 -> stamp of the last search that reached it
+        vector<int> pushed;             // var -> number of the call that implied it
+        int stamp, calls;
+
+        // Scratch of filter and hall_event, sized once in init. The Tarjan state of vid2 is
+        // only valid if numbered[vid2] == calls.
+        vector<int> numbered, order, low, comp;
+        vector<char> touches, comp_free;
+        vector<int> tarjan, frame_vid2, frame_var, event_of;
+        vector<int> todo, closed;
+
+        bool edge (const Solver& solver, Var v) const;
+        bool augment (const Solver& solver, int vid2);
+        int  hall_event (const Solver& solver, int vid2);
+
+    public:
+        AllDifferent (const Isosat &_isosat) : isosat(_isosat), injective(true), matching(false),
+                                               stamp(0), calls(0) {};
+        void init (bool _injective, bool _matching);
+        bool filter (const Solver& solver, vec<Lit>& out);
+
+        bool propagate (const Solver& solver, Lit p, vec<Lit>& out);
+        void explain (const Solver& solver, Lit p, vec<Lit>& out);
+        void backtrack (const Solver& solver, int level);
+};
+
+
+// Non-edges of an induced mapping: a true M(u2,u1) falsifies M(v2,v1) for every target
+// neighbour v1 of u1 whose pattern counterpart v2 is not a neighbour of u2 in that direction.
+class NonEdges : public Propagator {
+    private:
+        const Isosat &isosat;
+        bool directed;
+        int words;
+        vector<uint64_t> adj2;          // pattern adjacency matrix, row u2 has bit v2 for u2 -> v2
+        vector<int> reason_of;          // var -> true var that falsified it
+        vector<int> pushed;             // var -> number of the call that implied it
+        int calls;
+
+        bool adjacent2 (int u2, int v2) const { return (adj2[(size_t)u2*words + v2/64] >> (v2%64)) & 1; };
+        void falsify (const Solver& solver, Var u, const Adjacency &adj1, bool out, vec<Lit>& lits);
+
+    public:
+        NonEdges (const Isosat &_isosat) : isosat(_isosat), directed(false), words(0), calls(0) {};
+        void init (bool _directed);
+
+        bool propagate (const Solver& solver, Lit p, vec<Lit>& out);
+        void explain (const Solver& solver, Lit p, vec<Lit>& out);
+};
+
+
+// Forward checking on bitset domains: live holds the candidates of each pattern vertex that
+// are not cut yet. A true M(u2,u1) ANDs the row of every pattern neighbour v2 with the
+// target neighbourhood of u1 a word at a time, and falsifies the pairs that drop out.
+class ForwardCheck : public Propagator {
+    private:
+        const Isosat &isosat;
+        bool directed;
+        int words;
+        vector<uint64_t> live;          // vid2 -> bitset over vid1 of the candidates not cut yet
+        vector<uint64_t> layout;        // vid2 -> bitset over vid1 of the candidate variables
+        vector<int> rank;               // first candidate variable of each word of layout
+        vector<uint64_t> nbr_bits;      // scratch target neighbourhood
+        vector<int> reason_of;          // var -> true var that falsified it
+
+        struct Cut { int word; uint64_t bits; int level; };
+        vector<Cut> trail;              // cleared live bits, restored on backtrack
+
+        Var  var_of (int vid2, int vid1) const;
+        void cut (const Solver& solver, Var u, const Adjacency &adj1, const Adjacency &adj2, vec<Lit>& out);
+        void cut_word (const Solver& solver, Var u, int v2, int w, vec<Lit>& out);
+
+    public:
+        ForwardCheck (const Isosat &_isosat) : isosat(_isosat), directed(false), words(0) {};
+        void init (bool _directed);
+
+        bool propagate (const Solver& solver, Lit p, vec<Lit>& out);
+        void explain (const Solver& solver, Lit p, vec<Lit>& out);
+        void backtrack (const Solver& solver, int level);
+};
+
+
+// Fail-first branching: the unplaced pattern vertex with the fewest open candidates, ties to
+// the higher degree, goes to the open candidate whose degree is closest to its own.
+class FailFirst : public Brancher, public Propagator {
+    private:
+        const Isosat &isosat;
+        vector<int> degree2;            // vid2 -> pattern degree
+        vector<Var> by_closeness;       // mapping variables of each row, closest degree first
+
+        // Row counts kept up to date from the mapping literals, so decide does not rescan
+        // the candidate table. assigned stacks the literals heard, by decision level.
+        vector<int> open;               // vid2 -> unassigned candidates
+        vector<int> placed;             // vid2 -> true candidates
+        struct Assigned { Lit p; int level; };
+        vector<Assigned> assigned;
+
+        // The unplaced rows with an open candidate, fewest open first, ties to the higher degree.
+        struct RowLt {
+            const vector<int> &open, &degree;
+            bool operator () (int a, int b) const {
+                return open[a] < open[b] || (open[a] == open[b] && (degree[a] > degree[b] || (degree[a] == degree[b] && a < b))); }
+            RowLt (const vector<int> &_open, const vector<int> &_degree) : open(_open), degree(_degree) {}
+        };
+        Heap<int, RowLt> rows;
+        void update_row (int vid2);
+
+    public:
+        FailFirst (const Isosat &_isosat) : isosat(_isosat), rows(RowLt(open, degree2)) {};
+        void init ();
+
+        Lit decide (const Solver& solver);
+
+        bool propagate (const Solver& solver, Lit p, vec<Lit>& out);
+        void explain (const Solver& solver, Lit p, vec<Lit>& out) {};
+        void backtrack (const Solver& solver, int level);
+};
+
+
+// Broadcast ring of short learnt clauses between the solver copies of a parallel run. Writers
+// claim a position with one fetch_add and guard the slot with a sequence number (odd while it
+// is written), so every reader can check that what it copied was not overwritten meanwhile.
+// A writer never waits: it drops its clause if the slot is still busy. Readers keep their own
+// cursor and lose the clauses they were lapped on.
+class ClauseRing : public ClauseExchange {
+    private:
+        struct Slot {
+            std::atomic<uint64_t> seq;  // 2*pos+2 once the clause of position pos is written
+            std::atomic<int> origin;
+            std::atomic<int> size;
+        };
+
+        int max_size, max_lbd;
+        vector<Slot> slots;
+        vector< std::atomic<int> > lits;    // max_size literals per slot
+        std::atomic<uint64_t> head;     // next position to be claimed
+        vector<uint64_t> cursor;        // solver id -> next position to read
+
+    public:
+        ClauseRing (int solvers, int capacity, int max_size, int max_lbd)
+            : max_size(max_size), max_lbd(max_lbd), slots(capacity), lits((size_t)capacity * max_size),
+              head(0), cursor(solvers, 0) {
+            for (unsigned int i = 0; i < slots.size(); i++)
+                slots[i].seq = 0; };
+
+        void publish (int id, const vec<Lit>& clause, int lbd);
+        bool fetch (int id, vec<Lit>& out);
+};
+
+
 class Isosat {
+    friend class AllDifferent;
+    friend class NonEdges;
+    friend class ForwardCheck;
+    friend class FailFirst;
+
     private:
         
         int error;
         int v1_size, v2_size;
         int conflict_budget, propagation_budget;
-        Solver solver;
+        Solver *solver;                 // a SimpSolver only with options.simplify
+        IsosatOpts options;
+        bool directed;
+
+        // Mapping variables [0, n_map_vars) are laid out row by row: the candidates of vid2 are
+        // the variables cand_begin[vid2] .. cand_begin[vid2+1]-1, sorted by vid1.
+        int n_map_vars;
+        vector<int> cand_begin;         // vid2 -> first mapping variable
+        vector<int> cand_vid1;          // mapping variable -> vid1
+        vector<int> cand_vid2;          // mapping variable -> vid2
+        vector<int> col_begin;          // vid1 -> offset into col_var
+        vector<int> col_var;            // mapping variables grouped by vid1
+
+        // Vertex compatibility, evaluated once: bit vid1 of row vid2 is set if the pair passes
+        // the colour, degree and node_compat_fn tests (and refinement).
+        int domain_words;
+        vector<uint64_t> domain;
+        bool compatible (int vid2, int vid1) const {
+            return (domain[(size_t)vid2*domain_words + vid1/64] >> (vid1%64)) & 1; };
+
+        int edge_encoding;
+        Adjacency out1, in1;            // target adjacency
+        Adjacency out2, in2;            // pattern adjacency
+
+        // Pattern automorphisms as a stabilizer chain: level i fixes aut_base[0..i-1], and
+        // transversal[i] holds one automorphism onto each member of the orbit of aut_base[i].
+        vector<int> aut_base;
+        vector< vector< vector<int> > > transversal;
+
+        // Warm start: vid2 -> mapping variable of the hinted pair, var_Undef if there is none.
+        // Empty without a hint.
+        vector<Var> hint_var;
+        void apply_hint ();
+
+        // Projected enumeration: if projected, only the values of these variables tell
+        // two embeddings apart. See project_vertices and project_image.
+        bool projected;
+        vector<Var> projection;
+
+        int refine_domains (vector<uint64_t> &domain, bool directed, int threads);
+
+        int add_symmetry_breaking (const igraph_t *graph2,
+                const igraph_vector_int_t *vertex_colour2,
+                const igraph_vector_int_t *edge_colour2,
+                const IsosatOpts &opts);
+
+        void add_less (int vid2, const vector<int> &after);
+
+        bool edge_match (const igraph_t *graph1, const igraph_t *graph2,
+                const igraph_integer_t eid1,
+                const igraph_integer_t eid2,
+                const igraph_vector_int_t *edge_colour1,
+                const igraph_vector_int_t *edge_colour2,
+                igraph_isocompat_t *edge_compat_fn,
+                void *arg);
+
+        int add_support (const igraph_t *graph1, const igraph_t *graph2,
+                const igraph_integer_t eid2,
+                const igraph_vector_int_t *edge_colour1,
+                const igraph_vector_int_t *edge_colour2,
+                igraph_isocompat_t *edge_compat_fn,
+                void *arg);
+
+        AllDifferent injectivity;
+        NonEdges non_edges;
+        ForwardCheck forward_check;
+        FailFirst fail_first;
 
-        void minisat_cb (
-            const VMap<lbool> &assigns, 
-            const vec<Lit>& trail, 
-            vec<Lit>& infer_list);
+        void  attach_propagators ();
+        void  set_budgets ();
+        lbool search (const vec<Lit> *assumptions);
+        void  extract (igraph_vector_t *map12, igraph_vector_t *map21);
 
-        static void minisat_cb_wrapper (
-            void* object_pointer, 
-            const VMap<lbool> &assigns, 
-            const vec<Lit>& trail, 
-            vec<Lit>& infer_list);
+        // Cube-and-conquer: a cube places the first depth pattern vertices of the split
+        // order through assumption literals, and is split on the next one when it runs
+        // over its conflict budget.
+        struct Cube { vector<Lit> lits; int depth; };
+        void split_cube (const Cube &cube, const vector<int> &order, vector<Cube> &children);
 
         int set_size();
         string str (const vec<Lit> &vector);
@@ -186,7 +554,12 @@ class Isosat {
                 const igraph_vector_int_t *edge_colour2,
                 igraph_isocompat_t *node_compat_fn,
                 igraph_isocompat_t *edge_compat_fn,
-                void *arg);
+                void *arg,
+                const IsosatOpts &opts = IsosatOpts());
+
+        Isosat (const Isosat &base);
+        ~Isosat () { delete solver; };
+        Isosat& operator= (const Isosat &) = delete;
 
         int add_edge (const igraph_t *graph1, const igraph_t *graph2,
                 const igraph_integer_t eid,
@@ -204,13 +577,48 @@ class Isosat {
                 igraph_vector_t *map21,
                 const vec<Lit> *assumptions = NULL);
 
+        int solve_portfolio (int threads,
+                igraph_bool_t *iso,
+                igraph_vector_t *map12,
+                igraph_vector_t *map21);
+
+        int solve_cubes (int threads,
+                igraph_bool_t *iso,
+                igraph_vector_t *map12,
+                igraph_vector_t *map21);
+
+        int count_parallel (int threads, igraph_integer_t *count, igraph_integer_t limit = -1);
+
+        int hint (const igraph_vector_t *map12, const igraph_vector_t *map21);
+        int greedy_hint ();
+
+        void diversify (int seed);
+        void interrupt () { solver->interrupt(); };
+
         void setConfBudget(int budget) { conflict_budget    = budget; };
         void setPropBudget(int budget) { propagation_budget = budget; };
 
+        // All-solutions search without blocking clauses: enum_next returns the embeddings
+        // under the assumptions given to enum_start one by one, until iso is false.
+        void enum_start (const vec<Lit> *assumptions = NULL);
+        int  enum_next (igraph_bool_t *iso, igraph_vector_t *map12, igraph_vector_t *map21);
+
+        // Later enumerations find one embedding per distinct image of the pattern vertices
+        // vids2, or per distinct set of target vertices used.
+        int project_vertices (const igraph_vector_t *vids2);
+        int project_image ();
+
+        // Handed every embedding found by enumerate as (map12, map21), returns false to stop.
+        typedef function<bool (const igraph_vector_t *map12, const igraph_vector_t *map21)> Visitor;
+        int enumerate (igraph_integer_t max_maps, const Visitor &visit, igraph_integer_t *found);
+
         int negate (const igraph_vector_t *map12, igraph_vector_t *map21);
         int negate (const M21 v21_map);
         int get_error () {return error;}
 
+        igraph_integer_t aut_size ();
+        void expand (const igraph_vector_t *map21, igraph_integer_t index, igraph_vector_t *orbit21);
+
         Lit translate (const M21 &lit);
         M21 translate (const Lit &lit);
 };
@@ -18,6 +18,11 @@
 #include "subisosat.hpp"
 using namespace isosat;
 
+static const int CUBE_BUDGET = 1000;    // conflicts a cube may take before it is split
+static const int SHARE_SLOTS = 4096;    // capacity of the learnt clause ring
+static const int SHARE_SIZE  = 8;       // longest learnt clause that is shared
+static const int SHARE_LBD   = 4;       // highest literal block distance that is shared
+
 //#define DEBUG
 //#define DEBUG_SAT
 //#define MINISAT_VERBOSE
@@ -150,6 +155,10 @@ int igraph_vertex_degree (const igraph_t *graph1, const igraph_integer_t vid)
  * @param  arg
       Extra argument to supply to functions none_compat_fn and edge_compat_fn               
 
+ * @param induced
+      If true, graph2 must map onto an induced subgraph of graph1;
+      i.e. two vertices of graph2 without an edge must map to vertices of graph1 without one.
+
  * @return                          result
  * @version						              v0.01b
  ****************************************************************/
@@ -165,7 +174,8 @@ int igraph_test_isomorphic_map (
     const igraph_vector_t *map21,
     igraph_isocompat_t *node_compat_fn,
     igraph_isocompat_t *edge_compat_fn,
-    void *arg)
+    void *arg,
+    igraph_bool_t induced)
 {
     *iso = false;
 
@@ -309,6 +319,30 @@ int igraph_test_isomorphic_map (
         }
         
     }
+
+    /******************************
+     * Check non-edges (induced only)
+     * each edge of graph1 between mapped vertices must come from graph2
+     ******************************/
+    if (edges_ok && induced) {
+        vector<int> inverse(igraph_vcount(graph1), -1);
+        for (unsigned int vid2 = 0; vid2 < igraph_vector_size(&map); vid2++)
+            inverse[ (int)VECTOR(map)[vid2] ] = vid2;
+
+        for (unsigned int eid1 = 0; eid1 < igraph_ecount(graph1) && edges_ok; eid1++) {
+            int from1, to1;
+            igraph_edge(graph1, eid1, &from1, &to1);
+            if (inverse[from1] < 0 || inverse[to1] < 0)
+                continue;
+
+            int eid2(-1);
+            igraph_get_eid(graph2, &eid2, inverse[from1], inverse[to1], IGRAPH_DIRECTED, 0);
+            if (eid2 == -1) {
+//                cout << "test_isomorphic_map: unmatched edge in graph1" << endl;
+                edges_ok = false;
+            }
+        }
+    }
     igraph_vector_destroy(&map);
 
     if (!edges_ok) {
@@ -376,6 +410,19 @@ int igraph_test_isomorphic_map (
  * @param  arg
       Extra argument to supply to functions none_compat_fn and edge_compat_fn               
 
+ * @param induced
+      If true, graph2 must map onto an induced subgraph of graph1;
+      i.e. two vertices of graph2 without an edge must map to vertices of graph1 without one.
+
+ * @param threads
+      Number of solver threads. With more than one, differently seeded copies of the
+      encoding race each other and the first answer wins. Also used to build the domains,
+      so node_compat_fn must be thread-safe.
+
+ * @param cubes
+      If true, the threads split the search on the placement of the most constrained
+      pattern vertices (cube-and-conquer) instead of racing each other.
+
  * @return                          Error code.
  * @version						              v0.01b
  ****************************************************************/
@@ -391,19 +438,309 @@ int igraph_subisomorphic_sat (
     igraph_vector_t *map21,
     igraph_isocompat_t *node_compat_fn,
     igraph_isocompat_t *edge_compat_fn,
+    void *arg,
+    igraph_bool_t induced,
+    igraph_integer_t threads,
+    igraph_bool_t cubes)
+{
+    IsosatOpts opts;
+    opts.induced = induced;
+    opts.threads = threads;
+    Isosat isosat(graph1, graph2, vertex_colour1,vertex_colour2,
+                  edge_colour1, edge_colour2, node_compat_fn,
+                  edge_compat_fn, arg, opts);
+
+    if (cubes)
+        return isosat.solve_cubes(threads, iso, map12, map21);
+    return isosat.solve_portfolio(threads, iso, map12, map21);
+}
+
+
+
+/************************************************************//**
+ * @brief                           
+      Decides wheater there is a homomorphism from graph2 to graph1,
+      i.e. an edge preserving map that may send several vertices of
+      graph2 to the same vertex of graph1.
+      
+ * @param	graph1
+      The first input graph, may be directed or undirected.
+                                    
+ * @param	graph2
+      The second input graph, it must have the same directedness as graph1.
+                                  
+ * @param	vertex_colour1
+      An optional colour vector for the first graph.
+      Supply a null pointer here if your graphs are not coloured.
+                                  
+ * @param	vertex_colour2
+      An optional colour vector for the second graph.
+
+ * @param	edge_colour1
+      An optional edge colour vector for the first graph.
+      Supply a null pointer here if your graphs are not edge-coloured.
+                                  
+ * @param edge_colour2
+      The edge colour vector for the second graph.
+ 
+ * @param hom
+      Pointer to a boolean.
+      The result of the decision problem is stored here.
+                                    
+ * @param map21
+      Pointer to a vector ot NULL.
+      If not NULL, then a homomorphism from graph2 to graph1 is stored here.
+                                    
+ * @param node_compat_fn
+      A pointer to a function of type igraph_isocompat_t.
+                                    
+ * @param edge_compat_fn
+      A pointer to a function of type igraph_isocompat_t.
+                                    
+ * @param  arg
+      Extra argument to supply to functions none_compat_fn and edge_compat_fn               
+
+ * @return                          Error code.
+ * @version						              v0.01b
+ ****************************************************************/
+int igraph_homomorphic_sat (
+    const igraph_t *graph1,
+    const igraph_t *graph2, 
+    const igraph_vector_int_t *vertex_colour1,
+    const igraph_vector_int_t *vertex_colour2,
+    const igraph_vector_int_t *edge_colour1,
+    const igraph_vector_int_t *edge_colour2,
+    igraph_bool_t *hom,
+    igraph_vector_t *map21,
+    igraph_isocompat_t *node_compat_fn,
+    igraph_isocompat_t *edge_compat_fn,
     void *arg)
 {
+    IsosatOpts opts;
+    opts.homomorphism = true;
+    Isosat isosat(graph1, graph2, vertex_colour1,vertex_colour2,
+                  edge_colour1, edge_colour2, node_compat_fn,
+                  edge_compat_fn, arg, opts);
+
+    return isosat.solve(hom, NULL, map21);
+}
+
+
+/************************************************************//**
+ * @brief             frees the items already in maps with their own destructor and
+ *                    empties it, later items are igraph vectors
+ * @version						v0.01b
+ ****************************************************************/
+static void clear_maps (igraph_vector_ptr_t *maps) {
+    igraph_vector_ptr_free_all(maps);
+    igraph_vector_ptr_clear(maps);
+    IGRAPH_VECTOR_PTR_SET_ITEM_DESTRUCTOR(maps, &igraph_vector_destroy);
+}
+
+
+
+/************************************************************//**
+ * @brief             fills maps with the embeddings isosat enumerates, see
+ *                    igraph_get_subisomorphisms_sat for the parameters
+ * @version						v0.01b
+ ****************************************************************/
+static int collect_maps (
+    Isosat &isosat,
+    igraph_vector_ptr_t *maps,
+    igraph_vector_t *map12, 
+    igraph_vector_t *map21,
+    igraph_integer_t max_maps,
+    igraph_bool_t *reached)
+{
+    clear_maps(maps);
+    int error(IGRAPH_SUCCESS);
+    igraph_integer_t found;
+
+    int solve_error = isosat.enumerate(max_maps, [&] (const igraph_vector_t *m12, const igraph_vector_t *m21) {
+        igraph_vector_t *copy = igraph_Calloc(1, igraph_vector_t);
+        if (copy == NULL || igraph_vector_copy(copy, m21) != IGRAPH_SUCCESS) {
+            igraph_Free(copy);
+            error = IGRAPH_ENOMEM;
+            return false;
+        }
+        if (igraph_vector_ptr_push_back(maps, copy) != IGRAPH_SUCCESS) {
+            igraph_vector_destroy(copy);
+            igraph_Free(copy);
+            error = IGRAPH_ENOMEM;
+            return false;
+        }
+
+        if (igraph_vector_ptr_size(maps) == 1) {
+            if (map12 != NULL)
+                igraph_vector_update(map12, m12);
+            if (map21 != NULL)
+                igraph_vector_update(map21, m21);
+        }
+        return true;
+    }, &found);
+
+    if (reached != NULL)
+        *reached = (max_maps >= 0 && found >= max_maps);
+    return (error != IGRAPH_SUCCESS) ? error : solve_error;
+}
+
+
+
+/************************************************************//**
+ * @brief                           
+      Collects the subgraph isomorphisms from graph2 to graph1,
+      one solver session finds them one after another
+      
+ * @param	graph1, graph2, vertex_colour1, vertex_colour2, edge_colour1, edge_colour2
+      As for igraph_subisomorphic_sat.
+                                    
+ * @param maps
+      Pointer to an initialized pointer vector. Items already in it are freed
+      with its item destructor, if any, and it is cleared first.
+      On return it holds pointers to igraph_vector_t objects, each a mapping
+      from graph2 to graph1. Their item destructor is set, so
+      igraph_vector_ptr_destroy_all frees them.
+                                    
+ * @param map12
+      Pointer to a vector or NULL.
+      If not NULL, the first mapping from graph1 to graph2 found is stored here.
+                                 
+ * @param map21
+      Pointer to a vector or NULL.
+      If not NULL, the first mapping from graph2 to graph1 found is stored here.
+                                    
+ * @param node_compat_fn, edge_compat_fn, arg
+      As for igraph_subisomorphic_sat.
+
+ * @param induced
+      If true, only induced subgraphs of graph1 are matched.
+
+ * @param max_maps
+      Stop after this many mappings, negative for all of them.
+
+ * @param reached
+      Pointer to a boolean or NULL.
+      If not NULL, it is set to whether max_maps mappings were found; there may be more.
+
+ * @return                          Error code.
+ * @version						              v0.01b
+ ****************************************************************/
+int igraph_get_subisomorphisms_sat (
+    const igraph_t *graph1,
+    const igraph_t *graph2, 
+    const igraph_vector_int_t *vertex_colour1,
+    const igraph_vector_int_t *vertex_colour2,
+    const igraph_vector_int_t *edge_colour1,
+    const igraph_vector_int_t *edge_colour2,
+    igraph_vector_ptr_t *maps,
+    igraph_vector_t *map12, 
+    igraph_vector_t *map21,
+    igraph_isocompat_t *node_compat_fn,
+    igraph_isocompat_t *edge_compat_fn,
+    void *arg,
+    igraph_bool_t induced,
+    igraph_integer_t max_maps,
+    igraph_bool_t *reached)
+{
+    IsosatOpts opts;
+    opts.induced  = induced;
+    opts.symmetry = true;
     Isosat isosat(graph1, graph2, vertex_colour1,vertex_colour2,
                   edge_colour1, edge_colour2, node_compat_fn,
-                  edge_compat_fn, arg);
+                  edge_compat_fn, arg, opts);
+
+    return collect_maps(isosat, maps, map12, map21, max_maps, reached);
+}
+
+
+
+/************************************************************//**
+ * @brief                           
+      Calls isohandler_fn with every subgraph isomorphism from graph2 to graph1
+      as soon as the solver finds it; nothing is collected, so memory does not
+      grow with the number of mappings
+      
+ * @param	graph1, graph2, vertex_colour1, vertex_colour2, edge_colour1, edge_colour2
+      As for igraph_subisomorphic_sat.
+                                    
+ * @param map12
+      Pointer to a vector or NULL.
+      If not NULL, the last mapping from graph1 to graph2 handed on is stored here.
+                                 
+ * @param map21
+      Pointer to a vector or NULL.
+      If not NULL, the last mapping from graph2 to graph1 handed on is stored here.
+                                    
+ * @param isohandler_fn
+      A pointer to a function of type igraph_isohandler_t, called with map12, map21
+      and arg. The vectors are only valid during the call. If it returns false, the
+      search stops.
 
-    return isosat.solve(iso, map12, map21);
+ * @param node_compat_fn, edge_compat_fn, arg
+      As for igraph_subisomorphic_sat.
+
+ * @param induced
+      If true, only induced subgraphs of graph1 are matched.
+
+ * @param max_maps
+      Stop after this many mappings, negative for all of them.
+
+ * @param reached
+      Pointer to a boolean or NULL.
+      If not NULL, it is set to whether max_maps mappings were handed on.
+
+ * @return                          Error code.
+ * @version						              v0.01b
+ ****************************************************************/
+int igraph_subisomorphic_function_sat (
+    const igraph_t *graph1,
+    const igraph_t *graph2, 
+    const igraph_vector_int_t *vertex_colour1,
+    const igraph_vector_int_t *vertex_colour2,
+    const igraph_vector_int_t *edge_colour1,
+    const igraph_vector_int_t *edge_colour2,
+    igraph_vector_t *map12, 
+    igraph_vector_t *map21,
+    igraph_isohandler_t *isohandler_fn,
+    igraph_isocompat_t *node_compat_fn,
+    igraph_isocompat_t *edge_compat_fn,
+    void *arg,
+    igraph_bool_t induced,
+    igraph_integer_t max_maps,
+    igraph_bool_t *reached)
+{
+    IsosatOpts opts;
+    opts.induced  = induced;
+    opts.symmetry = true;
+    Isosat isosat(graph1, graph2, vertex_colour1,vertex_colour2,
+                  edge_colour1, edge_colour2, node_compat_fn,
+                  edge_compat_fn, arg, opts);
+
+    igraph_integer_t found;
+    int error = isosat.enumerate(max_maps, [&] (const igraph_vector_t *m12, const igraph_vector_t *m21) {
+        if (map12 != NULL)
+            igraph_vector_update(map12, m12);
+        if (map21 != NULL)
+            igraph_vector_update(map21, m21);
+        return (bool) isohandler_fn(m12, m21, arg);
+    }, &found);
+
+    if (reached != NULL)
+        *reached = (max_maps >= 0 && found >= max_maps);
+    return error;
 }
 
 
+
 /************************************************************//**
  * @brief	
- * @return            string representation of connective	
+ * @param threads     with more than one, the count is split by the target of
+ *                    pattern vertex 0 over this many solvers; the preprocessing
+ *                    only uses them without compat functions
+ * @param threshold   stop once count reaches it, negative to count them all
+ * @param reached     if not NULL, set to whether the threshold was reached; the
+ *                    count is then clamped to threshold
+ * @return            error code, IGRAPH_INTERRUPTED if a budget ran out	
  * @version						v0.01b
  ****************************************************************/
 int igraph_count_subisomorphisms_sat (
@@ -416,34 +753,197 @@ int igraph_count_subisomorphisms_sat (
     igraph_integer_t *count,
     igraph_isocompat_t *node_compat_fn,
     igraph_isocompat_t *edge_compat_fn,
-    void *arg)
+    void *arg,
+    igraph_bool_t induced,
+    igraph_integer_t threads,
+    igraph_integer_t threshold,
+    igraph_bool_t *reached)
 {
+    IsosatOpts opts;
+    opts.induced  = induced;
+    opts.symmetry = true;
+    // the count workers never call the compat functions, the preprocessing does; keep
+    // that serial so node_compat_fn need not be thread-safe here
+    opts.threads  = (node_compat_fn == NULL && edge_compat_fn == NULL) ? threads : 1;
     Isosat isosat(graph1, graph2, vertex_colour1,vertex_colour2,
                   edge_colour1, edge_colour2, node_compat_fn,
-                  edge_compat_fn, arg);
+                  edge_compat_fn, arg, opts);
 
+    // canonical embeddings needed to reach the threshold
+    igraph_integer_t orbit = isosat.aut_size();
+    igraph_integer_t limit = (threshold < 0) ? -1 : (threshold + orbit - 1) / orbit;
+
+    int error(IGRAPH_SUCCESS);
+    if (threads > 1) {
+        error = isosat.count_parallel(threads, count, limit);
+    } else {
+        igraph_bool_t iso(true);
+        *count = 0;
+        igraph_vector_t map21;
+        igraph_vector_init(&map21, igraph_vcount(graph2));
+        isosat.enum_start();
+        while (iso && error == IGRAPH_SUCCESS && (limit < 0 || *count < limit)) {
+            error = isosat.enum_next(&iso, NULL, &map21);
+            if (iso) {
+                #ifndef NDEBUG
+                    igraph_bool_t iso_test(false);
+                    igraph_test_isomorphic_map (graph1, graph2, vertex_colour1, vertex_colour2,
+                                                edge_colour1, edge_colour2, &iso_test,
+                                                NULL, &map21, node_compat_fn, edge_compat_fn, arg, induced);
+                    assert(iso_test);
+                #endif
+                (*count)++;
+            }
+        }
+        igraph_vector_destroy(&map21);
+    }
+
+    // every canonical embedding stands for its whole orbit under the pattern automorphisms,
+    // the last orbit may carry the count past the threshold
+    *count *= orbit;
+    if (threshold >= 0 && *count > threshold)
+        *count = threshold;
+    if (reached != NULL)
+        *reached = (threshold >= 0 && *count >= threshold);
+
+    return error;
+}
+
+
+
+/************************************************************//**
+ * @brief             sets up a projected enumeration, see
+ *                    igraph_count_subisomorphisms_projected_sat
+ * @version						v0.01b
+ ****************************************************************/
+static int setup_projection (Isosat &isosat, const igraph_vector_t *vids2) {
+    if (vids2 == NULL)
+        return isosat.project_image();
+    return isosat.project_vertices(vids2);
+}
+
+
+
+/************************************************************//**
+ * @brief                           
+      Counts the distinct projections of the subgraph isomorphisms from graph2
+      to graph1: embeddings that send the pattern vertices vids2 to the same
+      targets count once. The enumeration blocks only the projection, so each
+      class costs one solution rather than one per completion.
+      
+ * @param	graph1, graph2, vertex_colour1, vertex_colour2, edge_colour1, edge_colour2
+      As for igraph_subisomorphic_sat.
+                                    
+ * @param vids2
+      Pattern vertices to project onto.
+      If NULL, embeddings are projected onto the set of graph1 vertices they use.
+
+ * @param count
+      Pointer to an integer, the number of projections is stored here.
+                                    
+ * @param node_compat_fn, edge_compat_fn, arg
+      As for igraph_subisomorphic_sat.
+
+ * @param induced
+      If true, only induced subgraphs of graph1 are matched.
+
+ * @param threshold, reached
+      As for igraph_count_subisomorphisms_sat.
+
+ * @return                          Error code.
+ * @version						              v0.01b
+ ****************************************************************/
+int igraph_count_subisomorphisms_projected_sat (
+    const igraph_t *graph1,
+    const igraph_t *graph2, 
+    const igraph_vector_int_t *vertex_colour1,
+    const igraph_vector_int_t *vertex_colour2,
+    const igraph_vector_int_t *edge_colour1,
+    const igraph_vector_int_t *edge_colour2,
+    const igraph_vector_t *vids2,
+    igraph_integer_t *count,
+    igraph_isocompat_t *node_compat_fn,
+    igraph_isocompat_t *edge_compat_fn,
+    void *arg,
+    igraph_bool_t induced,
+    igraph_integer_t threshold,
+    igraph_bool_t *reached)
+{
+    // the image set is the same for every member of an orbit, a vertex subset need not be
+    IsosatOpts opts;
+    opts.induced  = induced;
+    opts.symmetry = (vids2 == NULL);
+    Isosat isosat(graph1, graph2, vertex_colour1,vertex_colour2,
+                  edge_colour1, edge_colour2, node_compat_fn,
+                  edge_compat_fn, arg, opts);
 
-    igraph_bool_t iso(true);
     *count = 0;
-    igraph_vector_t map21;
-    igraph_vector_init(&map21, igraph_vcount(graph2));
-    while (iso) {
-        isosat.solve(&iso, NULL, &map21);
-        if (iso) {
-            #ifndef NDEBUG
-                igraph_bool_t iso_test(false);
-                igraph_test_isomorphic_map (graph1, graph2, vertex_colour1, vertex_colour2,
-                                            edge_colour1, edge_colour2, &iso_test,
-                                            NULL, &map21, node_compat_fn, edge_compat_fn, arg);
-                assert(iso_test);
-            #endif
-            isosat.negate(NULL, &map21);
+    if (reached != NULL)
+        *reached = false;
+    int error = setup_projection(isosat, vids2);
+    if (error != IGRAPH_SUCCESS)
+        return error;
+
+    igraph_bool_t iso(true);
+    isosat.enum_start();
+    while (iso && error == IGRAPH_SUCCESS && (threshold < 0 || *count < threshold)) {
+        error = isosat.enum_next(&iso, NULL, NULL);
+        if (iso)
             (*count)++;
-        }
     }
-	igraph_vector_destroy(&map21);
 
-    return IGRAPH_SUCCESS;
+    if (reached != NULL)
+        *reached = (threshold >= 0 && *count >= threshold);
+    return error;
+}
+
+
+
+/************************************************************//**
+ * @brief                           
+      Collects one subgraph isomorphism from graph2 to graph1 per distinct
+      projection, see igraph_count_subisomorphisms_projected_sat
+      
+ * @param vids2
+      Pattern vertices to project onto, or NULL for the set of graph1 vertices used.
+
+ * @param maps, max_maps, reached
+      As for igraph_get_subisomorphisms_sat.
+
+ * @return                          Error code.
+ * @version						              v0.01b
+ ****************************************************************/
+int igraph_get_subisomorphisms_projected_sat (
+    const igraph_t *graph1,
+    const igraph_t *graph2, 
+    const igraph_vector_int_t *vertex_colour1,
+    const igraph_vector_int_t *vertex_colour2,
+    const igraph_vector_int_t *edge_colour1,
+    const igraph_vector_int_t *edge_colour2,
+    const igraph_vector_t *vids2,
+    igraph_vector_ptr_t *maps,
+    igraph_isocompat_t *node_compat_fn,
+    igraph_isocompat_t *edge_compat_fn,
+    void *arg,
+    igraph_bool_t induced,
+    igraph_integer_t max_maps,
+    igraph_bool_t *reached)
+{
+    IsosatOpts opts;
+    opts.induced  = induced;
+    opts.symmetry = (vids2 == NULL);
+    Isosat isosat(graph1, graph2, vertex_colour1,vertex_colour2,
+                  edge_colour1, edge_colour2, node_compat_fn,
+                  edge_compat_fn, arg, opts);
+
+    clear_maps(maps);
+    if (reached != NULL)
+        *reached = false;
+    int error = setup_projection(isosat, vids2);
+    if (error != IGRAPH_SUCCESS)
+        return error;
+
+    return collect_maps(isosat, maps, NULL, NULL, max_maps, reached);
 }
 
 
@@ -504,20 +1004,127 @@ string isosat::str (const igraph_vector_t &vector) {
 
 
 
-/*****************************************************************************
- *****************************************************************************
- * 
- * Isosat Class
- *         
- *****************************************************************************
- *****************************************************************************/
-
-
-
-
 /************************************************************//**
- * @brief	
- * @return            string representation of connective	
+ * @brief             build compressed adjacency lists of graph
+ * @param mode        IGRAPH_OUT (from -> to) or IGRAPH_IN (to -> from),
+ *                    ignored for undirected graphs
+ * @version						v0.01b
+ ****************************************************************/
+void Adjacency::init (const igraph_t *graph, igraph_neimode_t mode) {
+    int v_size = igraph_vcount(graph);
+    int e_size = igraph_ecount(graph);
+    bool both  = !igraph_is_directed(graph);
+
+    begin.assign(v_size+1, 0);
+    for (unsigned int eid = 0; eid < e_size; eid++) {
+        int from, to;
+        igraph_edge(graph, eid, &from, &to);
+        if (both) {
+            begin[from+1]++;
+            begin[to+1]++;
+        } else {
+            begin[(mode == IGRAPH_OUT ? from:to) + 1]++;
+        }
+    }
+
+    for (unsigned int vid = 0; vid < v_size; vid++)
+        begin[vid+1] += begin[vid];
+
+    nbr.resize(begin[v_size]);
+    eid.resize(begin[v_size]);
+    vector<int> fill(begin.begin(), begin.end()-1);
+    for (unsigned int e = 0; e < e_size; e++) {
+        int from, to;
+        igraph_edge(graph, e, &from, &to);
+        if (both || mode == IGRAPH_OUT) {
+            nbr[fill[from]] = to;
+            eid[fill[from]++] = e;
+        }
+        if (both || mode != IGRAPH_OUT) {
+            nbr[fill[to]] = from;
+            eid[fill[to]++] = e;
+        }
+    }
+}
+
+
+
+
+/************************************************************//**
+ * @brief             distinct-neighbour degree and neighbour colour histograms
+ * @param vertex_colour     NULL to only compute degrees
+ * @version						v0.01b
+ ****************************************************************/
+void NbrProfile::init (const Adjacency &adj, const igraph_vector_int_t *vertex_colour) {
+    int v_size = adj.begin.size() - 1;
+    degree.assign(v_size, 0);
+    begin.assign(v_size+1, 0);
+    colour.clear();
+    count.clear();
+
+    vector<int> nbrs;
+    for (unsigned int vid = 0; vid < v_size; vid++) {
+        begin[vid] = colour.size();
+        nbrs.assign(adj.nbr.begin() + adj.begin[vid], adj.nbr.begin() + adj.begin[vid+1]);
+        sort(nbrs.begin(), nbrs.end());
+        nbrs.erase(unique(nbrs.begin(), nbrs.end()), nbrs.end());
+        degree[vid] = nbrs.size();
+
+        if (vertex_colour == NULL)
+            continue;
+
+        for (unsigned int i = 0; i < nbrs.size(); i++)
+            nbrs[i] = VECTOR(*vertex_colour)[nbrs[i]];
+        sort(nbrs.begin(), nbrs.end());
+        for (unsigned int i = 0; i < nbrs.size(); i++) {
+            if (i == 0 || nbrs[i] != nbrs[i-1]) {
+                colour.push_back(nbrs[i]);
+                count.push_back(0);
+            }
+            count.back()++;
+        }
+    }
+    begin[v_size] = colour.size();
+}
+
+
+
+/************************************************************//**
+ * @brief             can the neighbourhood of pattern vertex vid2 be embedded
+ *                    into that of target vertex vid1 (this profile)
+ * @version						v0.01b
+ ****************************************************************/
+bool NbrProfile::dominates (int vid1, const NbrProfile &pattern, int vid2) const {
+    if (degree[vid1] < pattern.degree[vid2])
+        return false;
+
+    int i = begin[vid1];
+    for (int j = pattern.begin[vid2]; j < pattern.begin[vid2+1]; j++) {
+        while (i < begin[vid1+1] && colour[i] < pattern.colour[j])
+            i++;
+        if (i == begin[vid1+1] || colour[i] != pattern.colour[j] || count[i] < pattern.count[j])
+            return false;
+    }
+    return true;
+}
+
+
+
+
+/*****************************************************************************
+ *****************************************************************************
+ * 
+ * Isosat Class
+ *         
+ *****************************************************************************
+ *****************************************************************************/
+
+
+
+
+/************************************************************//**
+ * @brief	
+ * @return            string representation of connective	
  * @version						v0.01b
  ****************************************************************/
 string Isosat::str (const vec<Lit> &vector) {
@@ -531,11 +1138,11 @@ string Isosat::str (const vec<Lit> &vector) {
 
 /************************************************************//**
  * @brief	
- * @return            string representation of connective	
+ * @return            number of mapping variables	
  * @version						v0.01b
  ****************************************************************/
 int Isosat::set_size () {
-    return v1_size*v2_size;
+    return n_map_vars;
 }
 
 
@@ -553,105 +1160,382 @@ Isosat::Isosat (
     const igraph_vector_int_t *edge_colour2,
     igraph_isocompat_t *node_compat_fn,
     igraph_isocompat_t *edge_compat_fn,
-    void *arg)
+    void *arg,
+    const IsosatOpts &opts)
     : error(IGRAPH_FAILURE)
     , conflict_budget(-1)
     , propagation_budget(-1)
+    , solver(opts.simplify ? new SimpSolver : new Solver)
+    , options(opts)
+    , n_map_vars(0)
+    , edge_encoding(opts.edge_encoding)
+    , projected(false)
+    , injectivity(*this)
+    , non_edges(*this)
+    , forward_check(*this)
+    , fail_first(*this)
 {
     /******************************
      * Setup Solver
+     * restarts follow the recent LBDs rather than the solver's fixed sequence
      ******************************/
+    solver->glucose_restart = true;
+
     v1_size = igraph_vcount(graph1);
     v2_size = igraph_vcount(graph2);
-    solver.callback_obj_pt  = this;
-    solver.callback         = &Isosat::minisat_cb_wrapper;
-
-    while ( solver.nVars() < set_size())
-        solver.newVar();
 
 //    igraph_set_error_handler(igraph_error_handler_ignore);
 
+    out1.init(graph1, IGRAPH_OUT);
+    in1.init(graph1, IGRAPH_IN);
+    out2.init(graph2, IGRAPH_OUT);
+    in2.init(graph2, IGRAPH_IN);
+
     /******************************
-     * Add G to solver (most of formual is done in callbacks)
-     * 1 - x_jk must have at least 1 entry per j
-     * 2 - x_jk must be false if incorrect vertex match
-     * O(n^2)using namespace formula;
+     * Degree / neighbour colour profiles
+     * computed once per graph, colours only used when both graphs are coloured
      ******************************/
-    for (unsigned int vid2 = 0; vid2 < igraph_vcount(graph2); vid2++) {
-        vec<Lit> clause;
-        for (unsigned int vid1 = 0; vid1 < igraph_vcount(graph1); vid1++) {
-            
-            bool match(true);
-            if (vertex_colour1 != NULL && vertex_colour2 != NULL)
-                if (VECTOR(*vertex_colour1)[vid1] != VECTOR(*vertex_colour2)[vid2])
-                    match = false;
+    directed = igraph_is_directed(graph1);
+    bool coloured = (vertex_colour1 != NULL && vertex_colour2 != NULL);
+    bool degree_filter = opts.degree_filter && !opts.homomorphism;      // merged neighbours
+    bool matching      = opts.matching      && !opts.homomorphism;
+    NbrProfile out_prof1, in_prof1, out_prof2, in_prof2;
+    if (degree_filter) {
+        out_prof1.init(out1, coloured ? vertex_colour1:NULL);
+        out_prof2.init(out2, coloured ? vertex_colour2:NULL);
+        if (directed) {
+            in_prof1.init(in1, coloured ? vertex_colour1:NULL);
+            in_prof2.init(in2, coloured ? vertex_colour2:NULL);
+        }
+    }
 
-            if (node_compat_fn != NULL)
-                if (!(*node_compat_fn)(graph1, graph2, vid1, vid2, arg))
+    // an induced mapping can not send a vertex without a self-loop onto one with a self-loop
+    vector<char> loop1(v1_size, 0), loop2(v2_size, 0);
+    if (opts.induced) {
+        for (unsigned int vid1 = 0; vid1 < v1_size; vid1++)
+            for (int i = out1.begin[vid1]; i < out1.begin[vid1+1]; i++)
+                loop1[vid1] |= (out1.nbr[i] == vid1);
+        for (unsigned int vid2 = 0; vid2 < v2_size; vid2++)
+            for (int i = out2.begin[vid2]; i < out2.begin[vid2+1]; i++)
+                loop2[vid2] |= (out2.nbr[i] == vid2);
+    }
+
+    /******************************
+     * Domains
+     * bitset over vid1 per vid2, set if the pair passes the vertex tests
+     * O(n^2) compat tests, each pair evaluated once, rows split over the threads
+     ******************************/
+    int words = (v1_size + 63) / 64;
+    domain_words = words;
+    domain.assign((size_t)v2_size * words, 0);
+
+    int threads = max(1, min(opts.threads, v2_size));
+    auto build_rows = [&] (int t) {
+        for (int vid2 = t; vid2 < v2_size; vid2 += threads) {
+            uint64_t *row = &domain[(size_t)vid2 * words];
+            for (int vid1 = 0; vid1 < v1_size; vid1++) {
+
+                bool match(true);
+                if (vertex_colour1 != NULL && vertex_colour2 != NULL)
+                    if (VECTOR(*vertex_colour1)[vid1] != VECTOR(*vertex_colour2)[vid2])
+                        match = false;
+
+                if (match && degree_filter)
+                    if (!out_prof1.dominates(vid1, out_prof2, vid2) ||
+                        (directed && !in_prof1.dominates(vid1, in_prof2, vid2)) )
+                        match = false;
+
+                if (match && loop1[vid1] && !loop2[vid2])
                     match = false;
 
-           if (match) {
-                clause.push( translate(M21(vid2, vid1, false)) );
-            } else {
-                // restrictions
-                if ( !solver.addClause( translate(M21(vid2, vid1, true)) ) ) {
-                    #ifdef DEBUG
-                        cerr << "Error: addClause() " << formula::str(translate(M21(vid2, vid1, true))) << endl;
-                    #endif 
-                    error = IGRAPH_FAILURE;
-                    return;
-                }
-            }
+                if (match && node_compat_fn != NULL)
+                    if (!(*node_compat_fn)(graph1, graph2, vid1, vid2, arg))
+                        match = false;
 
+                if (match)
+                    row[vid1 / 64] |= (uint64_t)1 << (vid1 % 64);
+            }
         }
-
-        // no possible mapping return false
-        if (clause.size() == 0) {
+    };
+
+    // this thread takes the first share, so a single thread runs inline
+    vector<thread> workers;
+    for (int t = 1; t < threads; t++)
+        workers.push_back(thread(build_rows, t));
+    build_rows(0);
+    for (unsigned int i = 0; i < workers.size(); i++)
+        workers[i].join();
+
+    if (opts.refine)
+        refine_domains(domain, directed, opts.threads);
+
+    // an empty domain settles the query, no variables needed
+    for (unsigned int vid2 = 0; vid2 < v2_size; vid2++) {
+        const uint64_t *row = &domain[(size_t)vid2 * words];
+        bool empty(true);
+        for (int w = 0; w < words && empty; w++)
+            empty = (row[w] == 0);
+
+        if (empty) {
             #ifdef DEBUG
-              cerr << "Error in Setup: No possible vertex Mappings (row)" << endl;
+              cerr << "Setup: No possible vertex Mappings (row) " << vid2 << endl;
             #endif
-            error = IGRAPH_FAILURE;
-            return; 
+            solver->addEmptyClause();
+            error = IGRAPH_SUCCESS;
+            return;
+        }
+    }
+
+    /******************************
+     * Candidate table
+     * 1 - in sparse mode only pairs in the domain get a variable
+     * 2 - in dense mode every pair gets one, pairs outside the domain are fixed false
+     * O(#candidates) memory
+     ******************************/
+    vector<char> fixed_false;
+    cand_begin.resize(v2_size+1);
+    col_begin.assign(v1_size+1, 0);
+    for (unsigned int vid2 = 0; vid2 < v2_size; vid2++) {
+        const uint64_t *row = &domain[(size_t)vid2 * words];
+        cand_begin[vid2] = cand_vid1.size();
+        for (unsigned int vid1 = 0; vid1 < v1_size; vid1++) {
+
+            bool match = (row[vid1 / 64] >> (vid1 % 64)) & 1;
+            if (!match && opts.sparse)
+                continue;
+
+            // Lit packs 2*var+sign into an int
+            if (cand_vid1.size() >= (size_t)(INT32_MAX/2)) {
+                #ifdef DEBUG
+                  cerr << "Error in Setup: too many mapping variables" << endl;
+                #endif
+                error = IGRAPH_ENOMEM;
+                return;
+            }
+
+            cand_vid1.push_back(vid1);
+            cand_vid2.push_back(vid2);
+            col_begin[vid1+1]++;
+            if (!opts.sparse)
+                fixed_false.push_back(!match);
+        }
+    }
+    n_map_vars = cand_vid1.size();
+    cand_begin[v2_size] = n_map_vars;
+
+    for (unsigned int vid1 = 0; vid1 < v1_size; vid1++)
+        col_begin[vid1+1] += col_begin[vid1];
+
+    col_var.resize(n_map_vars);
+    vector<int> col_fill(col_begin.begin(), col_begin.end()-1);
+    for (Var v = 0; v < n_map_vars; v++)
+        col_var[ col_fill[cand_vid1[v]]++ ] = v;
+
+    while ( solver->nVars() < set_size())
+        solver->newVar();
+    attach_propagators();
+
+    /******************************
+     * Add G to solver (most of formual is done in callbacks)
+     * 1 - x_jk must have at least 1 entry per j
+     * 2 - x_jk must be false if incorrect vertex match (dense mode only)
+     * a clause that makes the formula unsatisfiable settles the query, the
+     * setup still succeeds and solve() reports it
+     ******************************/
+    for (unsigned int vid2 = 0; vid2 < v2_size && solver->okay(); vid2++) {
+        vec<Lit> clause;
+        for (Var v = cand_begin[vid2]; v < cand_begin[vid2+1]; v++) {
+            if (opts.sparse || !fixed_false[v])
+                clause.push( mkLit(v, false) );
+            else
+                solver->addClause( mkLit(v, true) );     // restrictions
         }
+
         #ifdef DEBUG_SAT
             cout << "row: " << str(clause) << endl;
         #endif
-        if ( !solver.addClause(clause) ) {
-              #ifdef DEBUG
-                  cerr << "Error: addClause() " << formula::str(clause) << endl;
-              #endif 
-              error = IGRAPH_FAILURE;
-              return;
-        }
-
+        solver->addClause(clause);
     }
 
 
     /******************************
      * Add H to solver
      * 3 - Each edge e in H geusing namespace formula;t's mapped to each edge in G
-     * O(n^2)
+     * O(|E(H)| * sum of candidate degrees) with the support encoding
      ******************************/
-    for (unsigned int eid2=0; eid2<igraph_ecount(graph2); eid2++) {
-        if (add_edge(graph1, graph2,
-                     eid2,
-                     vertex_colour1,
-                     vertex_colour2,
-                     edge_colour1,
-                     edge_colour2,
-                     node_compat_fn,
-                     edge_compat_fn,
-                     arg) != IGRAPH_SUCCESS) {
-            error = IGRAPH_FAILURE;
+
+    for (unsigned int eid2=0; eid2<igraph_ecount(graph2) && solver->okay(); eid2++) {
+        int edge_error = add_edge(graph1, graph2,
+                                  eid2,
+                                  vertex_colour1,
+                                  vertex_colour2,
+                                  edge_colour1,
+                                  edge_colour2,
+                                  node_compat_fn,
+                                  edge_compat_fn,
+                                  arg);
+        if (edge_error != IGRAPH_SUCCESS) {
+            error = edge_error;
             return;
         }
     }
 
+    /******************************
+     * Matching at the root
+     * 4 - no injective mapping of the domains settles the query
+     * 5 - pairs outside every matching are fixed false
+     ******************************/
+    if (matching && solver->okay()) {
+        vec<Lit> units;
+        if (!injectivity.filter(*solver, units)) {
+            #ifdef DEBUG
+              cerr << "Setup: No injective mapping of the domains" << endl;
+            #endif
+            solver->addEmptyClause();
+        }
+        for (int i = 0; i < units.size() && solver->okay(); i++)
+            solver->addClause(units[i]);
+    }
+
+    /******************************
+     * Fail-first branching decides the mapping variables,
+     * the edge auxiliaries follow by propagation
+     ******************************/
+    if (opts.fail_first)
+        for (Var v = n_map_vars; v < solver->nVars(); v++)
+            solver->setDecisionVar(v, false);
+
+    if (opts.greedy_start && solver->okay())
+        greedy_hint();
+
+    /******************************
+     * Symmetry breaking
+     * 6 - f(b) < f(x) for each base point b of the pattern automorphisms and x in its orbit
+     ******************************/
+    if (opts.symmetry && !opts.homomorphism && node_compat_fn == NULL && edge_compat_fn == NULL
+        && solver->okay()) {
+        error = add_symmetry_breaking(graph2, vertex_colour2, edge_colour2, opts);
+        if (error != IGRAPH_SUCCESS)
+            return;
+    }
+
+    /******************************
+     * Preprocessing
+     * 7 - eliminate the edge and order auxiliaries, the mapping
+     *     variables stay for the propagators and the model
+     ******************************/
+    if (opts.simplify) {
+        SimpSolver &simp = static_cast<SimpSolver&>(*solver);
+        for (Var v = 0; v < n_map_vars; v++)
+            simp.setFrozen(v, true);
+        #ifdef DEBUG
+          cout << "simplify: " << simp.nFreeVars() << " vars, " << simp.nClauses() << " clauses" << endl;
+        #endif
+        simp.eliminate(true);
+        #ifdef DEBUG
+          cout << "simplify: " << simp.nFreeVars() << " vars, " << simp.nClauses() << " clauses left" << endl;
+        #endif
+    }
+
     error = IGRAPH_SUCCESS;
 }
 
 
 
+/************************************************************//**
+ * @brief             copies the encoding of base into a fresh solver for a parallel
+ *                    worker; variables keep their numbers, learnt clauses and
+ *                    search state are not copied
+ * @version						v0.01b
+ ****************************************************************/
+Isosat::Isosat (const Isosat &base)
+    : error(base.error)
+    , v1_size(base.v1_size)
+    , v2_size(base.v2_size)
+    , conflict_budget(base.conflict_budget)
+    , propagation_budget(base.propagation_budget)
+    , solver(new Solver)
+    , options(base.options)
+    , directed(base.directed)
+    , n_map_vars(base.n_map_vars)
+    , cand_begin(base.cand_begin)
+    , cand_vid1(base.cand_vid1)
+    , cand_vid2(base.cand_vid2)
+    , col_begin(base.col_begin)
+    , col_var(base.col_var)
+    , domain_words(base.domain_words)
+    , domain(base.domain)
+    , edge_encoding(base.edge_encoding)
+    , out1(base.out1)
+    , in1(base.in1)
+    , out2(base.out2)
+    , in2(base.in2)
+    , aut_base(base.aut_base)
+    , transversal(base.transversal)
+    , hint_var(base.hint_var)
+    , projected(base.projected)
+    , projection(base.projection)
+    , injectivity(*this)
+    , non_edges(*this)
+    , forward_check(*this)
+    , fail_first(*this)
+{
+    solver->glucose_restart = base.solver->glucose_restart;
+    while (solver->nVars() < base.solver->nVars())
+        solver->newVar(l_Undef, base.solver->isDecisionVar(solver->nVars()));
+
+    if (error != IGRAPH_SUCCESS || !base.solver->okay()) {
+        solver->addEmptyClause();
+        return;
+    }
+    attach_propagators();
+
+    for (TrailIterator it = base.solver->trailBegin(); it != base.solver->trailEnd(); ++it)
+        solver->addClause(*it);
+
+    vec<Lit> clause;
+    for (ClauseIterator it = base.solver->clausesBegin(); it != base.solver->clausesEnd(); ++it) {
+        const Clause &c = *it;
+        clause.clear();
+        for (int i = 0; i < c.size(); i++)
+            clause.push(c[i]);
+        solver->addClause_(clause);
+    }
+    base.solver->binaryClauses(clause);
+    for (int i = 0; i < clause.size(); i += 2)
+        solver->addClause(clause[i], clause[i+1]);
+
+    if (!hint_var.empty())
+        apply_hint();
+}
+
+
+
+/************************************************************//**
+ * @brief             sets up the propagators over the mapping variables
+ * @version						v0.01b
+ ****************************************************************/
+void Isosat::attach_propagators () {
+    injectivity.init(!options.homomorphism, options.matching && !options.homomorphism);
+    // the matching has to hear about lost pairs, the others only act on true pairs
+    solver->attachPropagator(&injectivity, 0, set_size()-1, options.matching && !options.homomorphism);
+    if (options.induced) {
+        non_edges.init(directed);
+        solver->attachPropagator(&non_edges, 0, set_size()-1);
+    }
+    if (options.forward_check) {
+        forward_check.init(directed);
+        solver->attachPropagator(&forward_check, 0, set_size()-1);
+    }
+    if (options.fail_first) {
+        fail_first.init();
+        solver->attachBrancher(&fail_first);
+        solver->attachPropagator(&fail_first, 0, set_size()-1, true);
+    }
+}
+
+
+
 /************************************************************//**
  * @brief	
  * @version						v0.01b
@@ -670,6 +1554,9 @@ int Isosat::add_edge (
 {
     assert(v1_size == igraph_vcount(graph1));
     assert(v2_size == igraph_vcount(graph2));
+
+    if (edge_encoding == ENC_SUPPORT)
+        return add_support(graph1, graph2, eid2, edge_colour1, edge_colour2, edge_compat_fn, arg);
     
     int from2, to2;
     igraph_edge(graph2, eid2, &from2, &to2);
@@ -678,51 +1565,58 @@ int Isosat::add_edge (
     for (unsigned int eid1 = 0; eid1 < igraph_ecount(graph1); eid1++) {
         int from1, to1;
         igraph_edge(graph1, eid1, &from1, &to1);
-        
-        bool match(true);
-        if (vertex_colour1 != NULL && vertex_colour2 != NULL)
-            if ( VECTOR(*vertex_colour1)[from1] != VECTOR(*vertex_colour2)[from2] ||
-                 VECTOR(*vertex_colour1)[to1]   != VECTOR(*vertex_colour2)[to2] )
-                match = false;
-
-        if (node_compat_fn != NULL)
-            if ( !(*node_compat_fn)(graph1, graph2, from1, from2, arg) ||
-                 !(*node_compat_fn)(graph1, graph2, to1, to2, arg) )
-                match = false;
 
+        bool match(true);
         if (edge_colour1 != NULL && edge_colour2 != NULL)
             if (VECTOR(*edge_colour1)[eid1] != VECTOR(*edge_colour2)[eid2])
                 match = false;
 
-        if (edge_compat_fn != NULL)
+        if (match && edge_compat_fn != NULL)
             if (!(*edge_compat_fn)(graph1, graph2, eid1, eid2, arg))
                 match = false;
 
-        if (match) {
+        if (!match)
+            continue;
+
+        // an undirected target edge takes the pattern edge either way round
+        for (int turn = 0; turn < ((directed || from1 == to1) ? 1 : 2); turn++) {
+            int head1 = (turn == 0) ? from1 : to1;
+            int tail1 = (turn == 0) ? to1 : from1;
+
+            // vertex colours and node_compat_fn are served from the domains
+            if (!compatible(from2, head1) || !compatible(to2, tail1))
+                continue;
+
+            Lit from_lit = translate(M21(from2, head1));
+            Lit to_lit   = translate(M21(to2, tail1));
+            if (from_lit == lit_Undef || to_lit == lit_Undef)
+                continue;
+
             formula::Formula* phrase01 = new formula::Formula(formula::F_AND);
-            phrase01->add( translate(M21(from2, from1)) );
-            phrase01->add( translate(M21(to2, to1)) );
+            phrase01->add( from_lit );
+            phrase01->add( to_lit );
             phrase00.add(phrase01);
         }
     }
 
-    // no edge to map to
+    // no edge to map to, the pattern can't be matched and solve() reports it
     if (phrase00.size() == 0) {
         #ifdef DEBUG
-          cerr << "Error in Setup: No possible edge Mappings" << endl;
+          cerr << "Setup: No possible edge Mappings" << endl;
         #endif
-        return IGRAPH_FAILURE;
+        solver->addEmptyClause();
+        return IGRAPH_SUCCESS;
     }
 
     Lit cnf_out;
-    if (int err = phrase00.export_cnf(cnf_out, NULL, &solver) < 0) {
+    if (int err = phrase00.export_cnf(cnf_out, NULL, solver) < 0) {
         #ifdef DEBUG
           cerr << "Error in Setup: export_cnf failed" << endl;
         #endif
         return IGRAPH_FAILURE;
     }
 
-    solver.addClause(cnf_out);
+    solver->addClause(cnf_out);
     #ifdef DEBUG_SAT
         cout << "edge sat: " << endl << phrase00.str();
     #endif  
@@ -733,60 +1627,111 @@ int Isosat::add_edge (
 
 
 /************************************************************//**
- * @brief	
+ * @brief             computes the automorphisms of graph2 as a stabilizer chain,
+ *                    one SAT query per candidate image of each base point on an
+ *                    induced graph2 -> graph2 instance, and keeps one embedding
+ *                    per class: f(b) < f(x) for every x in the orbit of b
+ * @return            Error code.
  * @version						v0.01b
  ****************************************************************/
-int Isosat::solve (
-    igraph_bool_t *iso,
-    igraph_vector_t *map12, 
-    igraph_vector_t *map21,
-    const vec<Lit> *assumptions)
+int Isosat::add_symmetry_breaking (
+    const igraph_t *graph2,
+    const igraph_vector_int_t *vertex_colour2,
+    const igraph_vector_int_t *edge_colour2,
+    const IsosatOpts &opts)
 {
+    IsosatOpts aut_opts;
+    aut_opts.induced = true;
+    aut_opts.refine  = true;
+    aut_opts.threads = opts.threads;
+    Isosat aut(graph2, graph2, vertex_colour2, vertex_colour2,
+               edge_colour2, edge_colour2, NULL, NULL, NULL, aut_opts);
+    if (aut.get_error() != IGRAPH_SUCCESS)
+        return aut.get_error();
+
+    vector< vector<int> > gens;
+    igraph_vector_t map21;
+    igraph_vector_init(&map21, v2_size);
+    vec<Lit> assumptions;
+
+    for (int base = 0; base < v2_size; base++) {
+
+        // orbit of base under the generators fixing the earlier base points,
+        // u[x] maps base to x (empty if x is not reached yet)
+        vector<int> level_gens;
+        for (unsigned int g = 0; g < gens.size(); g++) {
+            bool fixes(true);
+            for (unsigned int j = 0; j < aut_base.size() && fixes; j++)
+                fixes = (gens[g][ aut_base[j] ] == aut_base[j]);
+            if (fixes)
+                level_gens.push_back(g);
+        }
 
-    *iso = false;
-    if (error != IGRAPH_SUCCESS) {
-        #ifdef DEBUG
-          cerr << "Error in solve(): setup failed" << endl;
-        #endif
-        return error;
-    }
-
-    if (conflict_budget > 0)
-        solver.setConfBudget(conflict_budget);
-
-    if (propagation_budget > 0)
-        solver.setPropBudget(propagation_budget);
-    
-    #ifdef MINISAT_VERBOSE
-      solver.verbosity = 99;
-    #endif
-
-    if (assumptions == NULL)
-        *iso = (solver.solveLimited(vec<Lit>()) == l_True);
-    else
-        *iso = (solver.solveLimited(*assumptions) == l_True);
-
-
-    if (*iso == true && (map12 != NULL || map21 != NULL) ) {
-
-        for (unsigned int vid1 = 0; vid1 < v1_size; vid1++) {
-
-            if (map12 != NULL)
-                VECTOR(*map12)[vid1] = -1;
-
-            for (unsigned int vid2 = 0; vid2 < v2_size; vid2++) {
-                if (solver.model[ var(translate(M21(vid2, vid1))) ] == l_True) {
-
-                    if (map12 != NULL)
-                          VECTOR(*map12)[vid1] = vid2;
-
-                    if (map21 != NULL)
-                          VECTOR(*map21)[vid2] = vid1;
-
+        vector< vector<int> > u(v2_size);
+        for (int vid2 = 0; vid2 < v2_size; vid2++)
+            u[base].push_back(vid2);
+
+        auto closure = [&] () {
+            vector<int> todo;
+            for (int x = 0; x < v2_size; x++)
+                if (!u[x].empty())
+                    todo.push_back(x);
+            while (!todo.empty()) {
+                int y = todo.back();
+                todo.pop_back();
+                for (unsigned int g = 0; g < level_gens.size(); g++) {
+                    const vector<int> &gen = gens[ level_gens[g] ];
+                    int z = gen[ u[y][base] ];
+                    if (!u[z].empty())
+                        continue;
+                    for (int vid2 = 0; vid2 < v2_size; vid2++)
+                        u[z].push_back( gen[ u[y][vid2] ] );
+                    todo.push_back(z);
                 }
             }
+        };
+        closure();
+
+        for (int x = 0; x < v2_size; x++) {
+            if (!u[x].empty() || aut.translate(M21(base, x)) == lit_Undef)
+                continue;
+
+            assumptions.clear();
+            for (unsigned int j = 0; j < aut_base.size(); j++)
+                assumptions.push( aut.translate(M21(aut_base[j], aut_base[j])) );
+            assumptions.push( aut.translate(M21(base, x)) );
+
+            igraph_bool_t found(false);
+            aut.solve(&found, NULL, &map21, &assumptions);
+            if (!found)
+                continue;
+
+            gens.push_back( vector<int>(v2_size) );
+            for (int vid2 = 0; vid2 < v2_size; vid2++)
+                gens.back()[vid2] = (int)VECTOR(map21)[vid2];
+            level_gens.push_back(gens.size()-1);
+            closure();
+        }
+
+        vector<int> orbit;
+        transversal.push_back( vector< vector<int> >() );
+        transversal.back().push_back( u[base] );
+        for (int x = 0; x < v2_size; x++) {
+            if (x != base && !u[x].empty()) {
+                orbit.push_back(x);
+                transversal.back().push_back( u[x] );
+            }
         }
+        aut_base.push_back(base);
+
+        if (!orbit.empty())
+            add_less(base, orbit);
     }
+    igraph_vector_destroy(&map21);
+
+    #ifdef DEBUG
+        cout << "symmetry: |Aut| = " << aut_size() << ", " << gens.size() << " generators" << endl;
+    #endif
 
     return IGRAPH_SUCCESS;
 }
@@ -794,107 +1739,1924 @@ int Isosat::solve (
 
 
 /************************************************************//**
- * @brief	
+ * @brief             f(vid2) < f(x) for all x in after, through the order variables
+ *                    L(k) = "vid2 maps to one of its first k+1 candidates"
  * @version						v0.01b
  ****************************************************************/
-int Isosat::negate (const igraph_vector_t *map12, igraph_vector_t *map21) {
-
-    if ( (map12 == NULL && map21 == NULL) || (map12 != NULL && map21 != NULL) )
-        return IGRAPH_ARPACK_MODEINV;
+void Isosat::add_less (int vid2, const vector<int> &after) {
+    int first = cand_begin[vid2];
+    int size  = cand_begin[vid2+1] - first;
+
+    // L(k) -> L(k-1) or M(vid2, c_k), so a true L(k) always has a true candidate at or below k
+    Var order = solver->nVars();
+    for (int k = 0; k < size; k++) {
+        solver->newVar(l_Undef, false);
+        if (k == 0)
+            solver->addClause( mkLit(order, true), mkLit(first, false) );
+        else
+            solver->addClause( mkLit(order+k, true), mkLit(first+k, false), mkLit(order+k-1, false) );
+    }
 
-    if (map21 != NULL) {
-        assert ( igraph_vector_size(map21) == v2_size );
-        vec<Lit> neg_list;
-        for (unsigned int vid2 = 0; vid2 < v2_size; vid2++) {
-            int vid1 = (int)VECTOR(*map21)[vid2];
-            neg_list.push( translate(M21(vid2, vid1, true)) );
+    for (unsigned int i = 0; i < after.size(); i++) {
+        int x = after[i];
+        for (Var w = cand_begin[x]; w < cand_begin[x+1]; w++) {
+            int below = lower_bound(cand_vid1.begin() + first, cand_vid1.begin() + first + size,
+                                    cand_vid1[w]) - (cand_vid1.begin() + first);
+            if (below == 0)
+                solver->addClause( mkLit(w, true) );
+            else
+                solver->addClause( mkLit(w, true), mkLit(order+below-1, false) );
         }
-        solver.addClause(neg_list);
-        #ifdef DEBUG
-            cout << "negate " << formula::str(neg_list) << endl;
-        #endif
-    } else {
-        assert ( igraph_vector_size(map12) == v1_size );
-        vec<Lit> neg_list;
-        for (unsigned int vid1 = 0; vid1 < v1_size; vid1++) {
-            int vid2 = (int)VECTOR(*map12)[vid1];
-            if (vid2 >= 0 && vid2 < v2_size) 
-                neg_list.push( translate(M21(vid2, vid1, true)) );
-        }
-        solver.addClause(neg_list);
-        #ifdef DEBUG
-            cout << "negate " << formula::str(neg_list) << endl;
-        #endif
     }
-    return 0;
 }
 
 
 
 /************************************************************//**
- * @brief	
+ * @brief             number of pattern automorphisms found by symmetry breaking,
+ *                    1 if it is off
  * @version						v0.01b
  ****************************************************************/
-M21 Isosat::translate (const Lit &lit) {
-    assert ( var(lit) <= set_size() );
-    return M21( var(lit)/v1_size, var(lit)%v1_size, sign(lit) );
+igraph_integer_t Isosat::aut_size () {
+    igraph_integer_t size(1);
+    for (unsigned int i = 0; i < transversal.size(); i++)
+        size *= transversal[i].size();
+    return size;
 }
 
 
 
 /************************************************************//**
- * @brief	
+ * @brief             the index-th member of the orbit of the embedding map21,
+ *                    index in [0, aut_size()), index 0 is map21 itself
  * @version						v0.01b
  ****************************************************************/
-Lit Isosat::translate (const M21 &lit) {
-//cout << ::str(lit) << " = " << formula::str(mkLit( lit.vid2*v1_size + lit.vid1, lit.sign )) << endl;
-    assert ( lit.vid1 < v1_size && lit.vid2 < v2_size );
-    return mkLit( lit.vid2*v1_size + lit.vid1, lit.sign );
-}
-
-
-
+void Isosat::expand (const igraph_vector_t *map21, igraph_integer_t index, igraph_vector_t *orbit21) {
+    assert ( igraph_vector_size(map21) == v2_size && igraph_vector_size(orbit21) == v2_size );
+
+    // automorphism u_1 u_2 ... u_k, one transversal element per level in mixed radix
+    vector<int> perm(v2_size);
+    for (int vid2 = 0; vid2 < v2_size; vid2++)
+        perm[vid2] = vid2;
+    for (int i = transversal.size()-1; i >= 0; i--) {
+        int radix = transversal[i].size();
+        const vector<int> &u = transversal[i][index % radix];
+        index /= radix;
+        for (int vid2 = 0; vid2 < v2_size; vid2++)
+            perm[vid2] = u[ perm[vid2] ];
+    }
 
-/************************************************************//**
- * @brief	
- * @version						v0.01b
- ****************************************************************/
-void Isosat::minisat_cb_wrapper (void* _object_pointer, const VMap<lbool> &assigns, const vec<Lit>& trail, vec<Lit>& infer_list) {
-    Isosat* object_pointer = (Isosat*) _object_pointer;
-    return object_pointer->minisat_cb(assigns, trail, infer_list);
+    for (int vid2 = 0; vid2 < v2_size; vid2++)
+        VECTOR(*orbit21)[vid2] = VECTOR(*map21)[ perm[vid2] ];
 }
 
 
 
 /************************************************************//**
- * @brief	
+ * @brief             iterated neighbourhood refinement of the domains to a fixpoint
+      vid1 stays in the domain of vid2 only if every pattern neighbour nbr2 of vid2
+      still has a domain member among the matching neighbours of vid1. Each round
+      reads the previous domains and writes a fresh copy, so the pattern vertices
+      are split over the worker threads without locking. The helper threads are
+      started once and wait for the next round in between.
+ * @return            number of rounds
  * @version						v0.01b
  ****************************************************************/
-void Isosat::minisat_cb (const VMap<lbool> &assigns, const vec<Lit>& trail, vec<Lit>& infer_list) {
-    if ( assigns[ var(trail.last()) ] == l_True && var(trail.last()) < set_size() ) {
-        M21 new_decide = translate(trail.last());
-
-        // negate all other variables in column
-        for (unsigned int vid1 = 0; vid1 < v1_size; vid1++) {
-            if (vid1 != new_decide.vid1)
-                infer_list.push( translate(M21(new_decide.vid2, vid1, true)) );
+int Isosat::refine_domains (vector<uint64_t> &domain, bool directed, int threads) {
+    int words = (v1_size + 63) / 64;
+    if (threads > v2_size)
+        threads = v2_size;
+    if (threads < 1)
+        threads = 1;
+
+    vector<uint64_t> next(domain.size());
+    vector<char> changed(threads);
+
+    auto refine_rows = [&] (int t) {
+        changed[t] = false;
+        for (int vid2 = t; vid2 < v2_size; vid2 += threads) {
+            const uint64_t *row  = &domain[(size_t)vid2 * words];
+            uint64_t       *nrow = &next[(size_t)vid2 * words];
+
+            for (int w = 0; w < words; w++) {
+                nrow[w] = row[w];
+                for (uint64_t bits = row[w]; bits != 0; bits &= bits - 1) {
+                    int vid1 = w*64 + __builtin_ctzll(bits);
+
+                    bool supported(true);
+                    for (int dir = 0; dir < (directed ? 2:1) && supported; dir++) {
+                        const Adjacency &adj1 = (dir == 0) ? out1:in1;
+                        const Adjacency &adj2 = (dir == 0) ? out2:in2;
+                        for (int j = adj2.begin[vid2]; j < adj2.begin[vid2+1] && supported; j++) {
+                            const uint64_t *nbr_row = &domain[(size_t)adj2.nbr[j] * words];
+                            supported = false;
+                            for (int i = adj1.begin[vid1]; i < adj1.begin[vid1+1] && !supported; i++) {
+                                int nbr1 = adj1.nbr[i];
+                                supported = (nbr_row[nbr1 / 64] >> (nbr1 % 64)) & 1;
+                            }
+                        }
+                    }
+
+                    if (!supported) {
+                        nrow[w] &= ~((uint64_t)1 << (vid1 % 64));
+                        changed[t] = true;
+                    }
+                }
+            }
         }
+    };
+
+    // helper t runs once rounds passes the rounds it has done; this thread takes
+    // share 0 and waits for the helpers before swapping the domains
+    std::mutex lock;
+    std::condition_variable wake, done;
+    int rounds(0), finished(0);
+    bool stop(false);
+
+    vector<thread> helpers;
+    for (int t = 1; t < threads; t++) {
+        helpers.push_back(thread([&, t] () {
+            for (int seen = 0; ; seen++) {
+                {
+                    std::unique_lock<std::mutex> guard(lock);
+                    wake.wait(guard, [&] { return stop || rounds > seen; });
+                    if (stop)
+                        return;
+                }
+                refine_rows(t);
+                std::lock_guard<std::mutex> guard(lock);
+                if (++finished == threads - 1)
+                    done.notify_one();
+            }
+        }));
+    }
 
-        // negate all other variables in row
-        for (unsigned int vid2 = 0; vid2 < v2_size; vid2++) {
-            if (vid2 != new_decide.vid2)
-                infer_list.push( translate(M21(vid2, new_decide.vid1, true)) );
+    while (true) {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            rounds++;
+            finished = 0;
         }
-        
-        #ifdef DEBUG
-            cout << "new_decide: " << formula::str(trail.last()) << endl;
-            cout << "infer_list: " << formula::str(infer_list) << endl;
-        #endif
+        wake.notify_all();
+        refine_rows(0);
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            done.wait(guard, [&] { return finished == threads - 1; });
+        }
+
+        domain.swap(next);
+        if (find(changed.begin(), changed.end(), true) == changed.end())
+            break;
     }
-}
 
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stop = true;
+    }
+    wake.notify_all();
+    for (unsigned int i = 0; i < helpers.size(); i++)
+        helpers[i].join();
 
+    #ifdef DEBUG
+        cout << "refine_domains: " << rounds << " rounds" << endl;
+    #endif
+    return rounds;
+}
 
 
 
+/************************************************************//**
+ * @brief             test edge colours and edge_compat_fn of a target/pattern edge pair
+ * @version						v0.01b
+ ****************************************************************/
+bool Isosat::edge_match (
+    const igraph_t *graph1,
+    const igraph_t *graph2,
+    const igraph_integer_t eid1,
+    const igraph_integer_t eid2,
+    const igraph_vector_int_t *edge_colour1,
+    const igraph_vector_int_t *edge_colour2,
+    igraph_isocompat_t *edge_compat_fn,
+    void *arg)
+{
+    if (edge_colour1 != NULL && edge_colour2 != NULL)
+        if (VECTOR(*edge_colour1)[eid1] != VECTOR(*edge_colour2)[eid2])
+            return false;
+
+    if (edge_compat_fn != NULL)
+        if (!(*edge_compat_fn)(graph1, graph2, eid1, eid2, arg))
+            return false;
+
+    return true;
+}
+
+
+
+/************************************************************//**
+ * @brief             support encoding of pattern edge eid2 = (from2, to2)
+ *                      M(from2,u1) -> OR M(to2,v1)   over out-neighbours v1 of u1
+ *                      M(to2,v1)   -> OR M(from2,u1) over in-neighbours u1 of v1
+ *                    built from the target adjacency lists, no auxiliary variables
+ * @version						v0.01b
+ ****************************************************************/
+int Isosat::add_support (
+    const igraph_t *graph1,
+    const igraph_t *graph2,
+    const igraph_integer_t eid2,
+    const igraph_vector_int_t *edge_colour1,
+    const igraph_vector_int_t *edge_colour2,
+    igraph_isocompat_t *edge_compat_fn,
+    void *arg)
+{
+    int from2, to2;
+    igraph_edge(graph2, eid2, &from2, &to2);
+
+    for (int dir = 0; dir < 2; dir++) {
+        int vid2             = (dir == 0) ? from2:to2;
+        int nbr2             = (dir == 0) ? to2:from2;
+        const Adjacency &adj = (dir == 0) ? out1:in1;
+
+        vec<Lit> clause;
+        for (Var v = cand_begin[vid2]; v < cand_begin[vid2+1]; v++) {
+            int vid1 = cand_vid1[v];
+            clause.clear();
+            clause.push( mkLit(v, true) );
+            for (int i = adj.begin[vid1]; i < adj.begin[vid1+1]; i++) {
+                if (!edge_match(graph1, graph2, adj.eid[i], eid2, edge_colour1, edge_colour2, edge_compat_fn, arg))
+                    continue;
+                Lit lit = translate(M21(nbr2, adj.nbr[i]));
+                if (lit != lit_Undef)
+                    clause.push(lit);
+            }
+
+            #ifdef DEBUG_SAT
+                cout << "edge support: " << formula::str(clause) << endl;
+            #endif
+            // false means the pattern can't be matched, solve() reports it
+            if (!solver->addClause(clause))
+                return IGRAPH_SUCCESS;
+        }
+    }
+
+    return IGRAPH_SUCCESS;
+}
+
+
+
+/************************************************************//**
+ * @brief	
+ * @version						v0.01b
+ ****************************************************************/
+int Isosat::solve (
+    igraph_bool_t *iso,
+    igraph_vector_t *map12, 
+    igraph_vector_t *map21,
+    const vec<Lit> *assumptions)
+{
+
+    *iso = false;
+    if (error != IGRAPH_SUCCESS) {
+        #ifdef DEBUG
+          cerr << "Error in solve(): setup failed" << endl;
+        #endif
+        return error;
+    }
+
+    *iso = (search(assumptions) == l_True);
+    if (*iso == true)
+        extract(map12, map21);
+
+    return IGRAPH_SUCCESS;
+}
+
+
+
+/************************************************************//**
+ * @brief             runs the solver under the budgets
+ * @return            l_Undef if a budget ran out or the search was interrupted
+ * @version						v0.01b
+ ****************************************************************/
+lbool Isosat::search (const vec<Lit> *assumptions) {
+    set_budgets();
+
+    if (assumptions == NULL)
+        return solver->solveLimited(vec<Lit>());
+    return solver->solveLimited(*assumptions);
+}
+
+
+
+/************************************************************//**
+ * @brief             hands the budgets on to the solver
+ * @version						v0.01b
+ ****************************************************************/
+void Isosat::set_budgets () {
+    if (conflict_budget > 0)
+        solver->setConfBudget(conflict_budget);
+
+    if (propagation_budget > 0)
+        solver->setPropBudget(propagation_budget);
+
+    #ifdef MINISAT_VERBOSE
+      solver->verbosity = 99;
+    #endif
+}
+
+
+
+/************************************************************//**
+ * @brief             starts an all-solutions search under assumptions; the solver
+ *                    splits the space on its decisions instead of blocking every
+ *                    embedding with a clause
+ * @version						v0.01b
+ ****************************************************************/
+void Isosat::enum_start (const vec<Lit> *assumptions) {
+    // the other variables are fixed by propagation once the mapping is, so the solver
+    // only decides (and the enumeration only flips) mapping and projection variables
+    vector<char> in_projection(solver->nVars(), false);
+    vec<Var> vars;
+    for (unsigned int i = 0; i < projection.size(); i++) {
+        in_projection[ projection[i] ] = true;
+        vars.push( projection[i] );
+    }
+    for (Var v = n_map_vars; v < solver->nVars(); v++)
+        solver->setDecisionVar(v, in_projection[v]);
+
+    vec<Lit> none;
+    if (!projected)
+        solver->enumStart(assumptions == NULL ? none : *assumptions);
+    else
+        solver->enumStart(assumptions == NULL ? none : *assumptions, vars);
+}
+
+
+
+/************************************************************//**
+ * @brief             projects the enumeration onto the targets of the pattern
+ *                    vertices vids2: embeddings that agree on them count once.
+ *                    Needs symmetry breaking off, the classes are not closed
+ *                    under pattern automorphisms.
+ * @version						v0.01b
+ ****************************************************************/
+int Isosat::project_vertices (const igraph_vector_t *vids2) {
+    if (aut_size() > 1)
+        return IGRAPH_EINVAL;
+
+    projected = true;
+    projection.clear();
+    for (unsigned int i = 0; i < igraph_vector_size(vids2); i++) {
+        int vid2 = (int)VECTOR(*vids2)[i];
+        if (vid2 < 0 || vid2 >= v2_size)
+            return IGRAPH_EINVVID;
+        // the setup stops early when no embedding can exist
+        if (error != IGRAPH_SUCCESS || !solver->okay())
+            continue;
+        for (Var v = cand_begin[vid2]; v < cand_begin[vid2+1]; v++)
+            projection.push_back(v);
+    }
+    return IGRAPH_SUCCESS;
+}
+
+
+
+/************************************************************//**
+ * @brief             projects the enumeration onto the set of target vertices in
+ *                    the image: U(vid1) <-> OR M(vid2,vid1) over the candidates
+ *                    of vid1, and embeddings that agree on all U count once
+ * @version						v0.01b
+ ****************************************************************/
+int Isosat::project_image () {
+    projected = true;
+    projection.clear();
+    if (error != IGRAPH_SUCCESS || !solver->okay())
+        return IGRAPH_SUCCESS;
+
+    vec<Lit> clause;
+    for (int vid1 = 0; vid1 < v1_size; vid1++) {
+        if (col_begin[vid1] == col_begin[vid1+1])
+            continue;
+
+        Var u = solver->newVar();
+        projection.push_back(u);
+        clause.clear();
+        clause.push( mkLit(u, true) );
+        for (int i = col_begin[vid1]; i < col_begin[vid1+1]; i++) {
+            solver->addClause( mkLit(col_var[i], true), mkLit(u, false) );
+            clause.push( mkLit(col_var[i], false) );
+        }
+        solver->addClause(clause);
+    }
+    return IGRAPH_SUCCESS;
+}
+
+
+
+/************************************************************//**
+ * @brief             next embedding of the search begun by enum_start
+ * @param iso         false once there are no more, or a budget ran out
+ * @return            IGRAPH_INTERRUPTED if a budget ran out, the next call resumes
+ * @version						v0.01b
+ ****************************************************************/
+int Isosat::enum_next (igraph_bool_t *iso, igraph_vector_t *map12, igraph_vector_t *map21) {
+
+    *iso = false;
+    if (error != IGRAPH_SUCCESS) {
+        #ifdef DEBUG
+          cerr << "Error in enum_next(): setup failed" << endl;
+        #endif
+        return error;
+    }
+
+    set_budgets();
+    lbool result = solver->enumNext();
+    if (result == l_Undef)
+        return IGRAPH_INTERRUPTED;
+
+    *iso = (result == l_True);
+    if (*iso == true)
+        extract(map12, map21);
+
+    return IGRAPH_SUCCESS;
+}
+
+
+
+/************************************************************//**
+ * @brief             reads the mapping out of the last model
+ * @version						v0.01b
+ ****************************************************************/
+void Isosat::extract (igraph_vector_t *map12, igraph_vector_t *map21) {
+
+    if (map12 != NULL || map21 != NULL) {
+
+        if (map12 != NULL)
+            for (unsigned int vid1 = 0; vid1 < v1_size; vid1++)
+                VECTOR(*map12)[vid1] = -1;
+
+        for (Var v = 0; v < set_size(); v++) {
+            if (solver->model[v] == l_True) {
+
+                if (map12 != NULL)
+                      VECTOR(*map12)[ cand_vid1[v] ] = cand_vid2[v];
+
+                if (map21 != NULL)
+                      VECTOR(*map21)[ cand_vid2[v] ] = cand_vid1[v];
+
+            }
+        }
+    }
+
+}
+
+
+
+/************************************************************//**
+ * @brief             gives a portfolio worker its own search settings;
+ *                    seed 0 keeps the defaults
+ * @version						v0.01b
+ ****************************************************************/
+void Isosat::diversify (int seed) {
+    if (seed <= 0)
+        return;
+
+    solver->random_seed     = 91648253 + 7919 * seed;
+    solver->random_var_freq = 0.01 * (seed % 4);
+    solver->rnd_pol         = (seed % 3 == 2);
+    solver->phase_saving    = (seed % 5 == 4) ? 0 : 2;
+    solver->glucose_restart = (seed % 2 == 1);
+    solver->luby_restart    = (seed % 4 == 0);
+    solver->restart_first   = 50 << (seed % 3);
+    solver->var_decay       = 0.95 - 0.01 * (seed % 4);
+}
+
+
+
+/************************************************************//**
+ * @brief             races threads differently seeded copies of the encoding,
+ *                    the first one to finish interrupts the rest
+ * @param threads     number of workers, this instance is worker 0
+ * @version						v0.01b
+ ****************************************************************/
+int Isosat::solve_portfolio (
+    int threads,
+    igraph_bool_t *iso,
+    igraph_vector_t *map12,
+    igraph_vector_t *map21)
+{
+    if (threads <= 1 || error != IGRAPH_SUCCESS || !solver->okay())
+        return solve(iso, map12, map21);
+
+    *iso = false;
+
+    /******************************
+     * Copy the encoding
+     ******************************/
+    vector<Isosat*> workers(threads, this);
+    {
+        vector<std::thread> pool;
+        for (int t = 1; t < threads; t++)
+            pool.push_back(std::thread([this, t, &workers] () {
+                    workers[t] = new Isosat(*this);
+                    workers[t]->diversify(t);
+                }));
+        for (unsigned int i = 0; i < pool.size(); i++)
+            pool[i].join();
+    }
+
+    ClauseRing ring(threads, SHARE_SLOTS, SHARE_SIZE, SHARE_LBD);
+    if (options.share)
+        for (int t = 0; t < threads; t++)
+            workers[t]->solver->attachExchange(&ring, t);
+
+    /******************************
+     * Race
+     ******************************/
+    std::atomic<int> winner(-1);
+    vector<lbool> result(threads, l_Undef);
+    {
+        vector<std::thread> pool;
+        for (int t = 0; t < threads; t++)
+            pool.push_back(std::thread([t, &workers, &winner, &result] () {
+                    result[t] = workers[t]->search(NULL);
+                    if (result[t] == l_Undef)
+                        return;
+                    int none = -1;
+                    if (winner.compare_exchange_strong(none, t))
+                        for (unsigned int i = 0; i < workers.size(); i++)
+                            if ((int)i != t)
+                                workers[i]->interrupt();
+                }));
+        for (unsigned int i = 0; i < pool.size(); i++)
+            pool[i].join();
+    }
+
+    #ifdef DEBUG
+      cout << "portfolio: worker " << winner.load() << " of " << threads << " finished first" << endl;
+    #endif
+
+    if (winner >= 0 && result[winner] == l_True) {
+        *iso = true;
+        workers[winner]->extract(map12, map21);
+    }
+
+    solver->clearInterrupt();
+    solver->attachExchange(NULL, 0);
+    for (int t = 1; t < threads; t++)
+        delete workers[t];
+
+    return IGRAPH_SUCCESS;
+}
+
+
+
+/************************************************************//**
+ * @brief             children of cube placing the next pattern vertex of order on
+ *                    each of its candidates that are still open at the root
+ * @version						v0.01b
+ ****************************************************************/
+void Isosat::split_cube (const Cube &cube, const vector<int> &order, vector<Cube> &children) {
+    int vid2 = order[cube.depth];
+
+    vector<bool> used(v1_size, false);
+    if (!options.homomorphism)
+        for (unsigned int i = 0; i < cube.lits.size(); i++)
+            used[ cand_vid1[var(cube.lits[i])] ] = true;
+
+    for (Var v = cand_begin[vid2]; v < cand_begin[vid2+1]; v++) {
+        if (used[ cand_vid1[v] ] || solver->value(v) == l_False)
+            continue;
+        Cube child = { cube.lits, cube.depth+1 };
+        child.lits.push_back( mkLit(v, false) );
+        children.push_back(child);
+    }
+}
+
+
+
+/************************************************************//**
+ * @brief             splits the search on the placement of the most constrained
+ *                    pattern vertices and solves the cubes on a work-stealing pool
+ *                    of solver copies; a cube over CUBE_BUDGET conflicts is split
+ *                    further. The budgets set on this instance are not applied.
+ * @param threads     number of workers, this instance is worker 0
+ * @version						v0.01b
+ ****************************************************************/
+int Isosat::solve_cubes (
+    int threads,
+    igraph_bool_t *iso,
+    igraph_vector_t *map12,
+    igraph_vector_t *map21)
+{
+    *iso = false;
+    if (error != IGRAPH_SUCCESS) {
+        #ifdef DEBUG
+          cerr << "Error in solve_cubes(): setup failed" << endl;
+        #endif
+        return error;
+    }
+    if (threads < 1)
+        threads = 1;
+    if (!solver->okay() || v2_size == 0)
+        return solve(iso, map12, map21);
+
+    /******************************
+     * Split order: fewest candidates first, then highest degree
+     ******************************/
+    vector<int> order(v2_size);
+    for (int vid2 = 0; vid2 < v2_size; vid2++)
+        order[vid2] = vid2;
+    std::stable_sort(order.begin(), order.end(), [this] (int a, int b) {
+            int size_a = cand_begin[a+1] - cand_begin[a];
+            int size_b = cand_begin[b+1] - cand_begin[b];
+            if (size_a != size_b)
+                return size_a < size_b;
+            return out2.degree(a) + in2.degree(a) > out2.degree(b) + in2.degree(b);
+        });
+
+    /******************************
+     * Initial cubes, dealt round robin
+     ******************************/
+    vector<Cube> cubes(1, Cube());
+    cubes[0].depth = 0;
+    while (cubes.size() < (size_t)8*threads && cubes[0].depth < v2_size) {
+        vector<Cube> next;
+        for (unsigned int i = 0; i < cubes.size(); i++)
+            split_cube(cubes[i], order, next);
+        cubes.swap(next);
+        if (cubes.empty())
+            return IGRAPH_SUCCESS;
+    }
+
+    vector<std::deque<Cube> > queue(threads);
+    vector<std::mutex> queue_lock(threads);
+    for (unsigned int i = 0; i < cubes.size(); i++)
+        queue[i % threads].push_back(cubes[i]);
+
+    vector<Isosat*> workers(threads, this);
+    {
+        vector<std::thread> pool;
+        for (int t = 1; t < threads; t++)
+            pool.push_back(std::thread([this, t, &workers] () {
+                    workers[t] = new Isosat(*this);
+                }));
+        for (unsigned int i = 0; i < pool.size(); i++)
+            pool[i].join();
+    }
+
+    ClauseRing ring(threads, SHARE_SLOTS, SHARE_SIZE, SHARE_LBD);
+    if (options.share)
+        for (int t = 0; t < threads; t++)
+            workers[t]->solver->attachExchange(&ring, t);
+
+    /******************************
+     * Conquer
+     ******************************/
+    std::atomic<int>  pending((int)cubes.size());
+    std::atomic<bool> done(false);
+    std::atomic<int>  winner(-1);
+
+    auto stop = [&workers, &done] () {
+        done = true;
+        for (unsigned int i = 0; i < workers.size(); i++)
+            workers[i]->interrupt();
+    };
+
+    auto conquer = [&] (int t) {
+        Isosat &worker = *workers[t];
+        vec<Lit> assumptions;
+        vector<Cube> children;
+        while (!done) {
+
+            // own queue from the back, steal from the front of the others
+            Cube cube;
+            bool found = false;
+            for (int k = 0; k < threads && !found; k++) {
+                int q = (t + k) % threads;
+                std::lock_guard<std::mutex> guard(queue_lock[q]);
+                if (queue[q].empty())
+                    continue;
+                if (k == 0) {
+                    cube = queue[q].back();
+                    queue[q].pop_back();
+                } else {
+                    cube = queue[q].front();
+                    queue[q].pop_front();
+                }
+                found = true;
+            }
+            if (!found) {
+                if (pending == 0)
+                    break;
+                std::this_thread::yield();
+                continue;
+            }
+
+            assumptions.clear();
+            for (unsigned int i = 0; i < cube.lits.size(); i++)
+                assumptions.push(cube.lits[i]);
+            if (cube.depth < v2_size)
+                worker.solver->setConfBudget(CUBE_BUDGET);
+            else
+                worker.solver->budgetOff();
+            lbool result = worker.solver->solveLimited(assumptions);
+
+            if (result == l_True) {
+                int none = -1;
+                if (winner.compare_exchange_strong(none, t))
+                    stop();
+            } else if (result == l_False) {
+                // refuted without the cube: the whole problem is unsatisfiable
+                if (worker.solver->conflict.size() == 0)
+                    stop();
+            } else if (!done) {
+                children.clear();
+                worker.split_cube(cube, order, children);
+                pending += children.size();
+                std::lock_guard<std::mutex> guard(queue_lock[t]);
+                for (unsigned int i = 0; i < children.size(); i++)
+                    queue[t].push_back(children[i]);
+            }
+            pending--;
+        }
+    };
+
+    {
+        vector<std::thread> pool;
+        for (int t = 1; t < threads; t++)
+            pool.push_back(std::thread(conquer, t));
+        conquer(0);
+        for (unsigned int i = 0; i < pool.size(); i++)
+            pool[i].join();
+    }
+
+    #ifdef DEBUG
+      cout << "cubes: " << cubes.size() << " initial, winner " << winner.load() << endl;
+    #endif
+
+    if (winner >= 0) {
+        *iso = true;
+        workers[winner]->extract(map12, map21);
+    }
+
+    solver->clearInterrupt();
+    solver->budgetOff();
+    solver->attachExchange(NULL, 0);
+    for (int t = 1; t < threads; t++)
+        delete workers[t];
+
+    return IGRAPH_SUCCESS;
+}
+
+
+
+/************************************************************//**
+ * @brief             counts the solutions in disjoint partitions, one per target
+ *                    of pattern vertex 0, on threads solver copies; each partition
+ *                    is enumerated under its assumption
+ * @param count       number of solutions, not scaled by aut_size()
+ * @param limit       the workers stop once they found this many together,
+ *                    negative for no limit
+ * @version						v0.01b
+ ****************************************************************/
+int Isosat::count_parallel (int threads, igraph_integer_t *count, igraph_integer_t limit) {
+    *count = 0;
+    if (error != IGRAPH_SUCCESS) {
+        #ifdef DEBUG
+          cerr << "Error in count_parallel(): setup failed" << endl;
+        #endif
+        return error;
+    }
+    if (threads < 1)
+        threads = 1;
+    if (v2_size == 0) {
+        *count = solver->okay() ? 1 : 0;
+        return IGRAPH_SUCCESS;
+    }
+    if (!solver->okay())
+        return IGRAPH_SUCCESS;
+
+    vector<Isosat*> workers(threads, this);
+    {
+        vector<std::thread> pool;
+        for (int t = 1; t < threads; t++)
+            pool.push_back(std::thread([this, t, &workers] () {
+                    workers[t] = new Isosat(*this);
+                }));
+        for (unsigned int i = 0; i < pool.size(); i++)
+            pool[i].join();
+    }
+
+    ClauseRing ring(threads, SHARE_SLOTS, SHARE_SIZE, SHARE_LBD);
+    if (options.share)
+        for (int t = 0; t < threads; t++)
+            workers[t]->solver->attachExchange(&ring, t);
+
+    std::atomic<int> next(cand_begin[0]);
+    std::atomic<igraph_integer_t> total(0);
+    std::atomic<bool> failed(false);
+    vector<igraph_integer_t> counts(threads, 0);
+    vector<int> errors(threads, IGRAPH_SUCCESS);
+
+    auto enumerate = [&] (int t) {
+        Isosat &worker = *workers[t];
+        vec<Lit> partition;
+        bool full(false);
+        for (Var v = next++; v < cand_begin[1] && !full && !failed; v = next++) {
+            partition.clear();
+            partition.push( mkLit(v, false) );
+            worker.enum_start(&partition);
+            igraph_bool_t iso(true);
+            while (iso && !full && !failed) {
+                errors[t] = worker.enum_next(&iso, NULL, NULL);
+                if (errors[t] != IGRAPH_SUCCESS) {
+                    failed = true;
+                } else if (iso) {
+                    // claim a slot first, a solution past the limit gives it back
+                    if (limit >= 0 && total.fetch_add(1) >= limit) {
+                        total--;
+                        full = true;
+                    } else {
+                        counts[t]++;
+                    }
+                }
+            }
+        }
+    };
+
+    {
+        vector<std::thread> pool;
+        for (int t = 1; t < threads; t++)
+            pool.push_back(std::thread(enumerate, t));
+        enumerate(0);
+        for (unsigned int i = 0; i < pool.size(); i++)
+            pool[i].join();
+    }
+
+    #ifdef DEBUG
+      for (int t = 0; t < threads; t++)
+          cout << "count_parallel: worker " << t << " found " << (int)counts[t] << endl;
+    #endif
+
+    int result = IGRAPH_SUCCESS;
+    for (int t = 0; t < threads; t++) {
+        *count += counts[t];
+        if (errors[t] != IGRAPH_SUCCESS)
+            result = errors[t];
+    }
+
+    solver->attachExchange(NULL, 0);
+    for (int t = 1; t < threads; t++)
+        delete workers[t];
+
+    return result;
+}
+
+
+
+/************************************************************//**
+ * @brief             finds the embeddings one after another in this session and hands
+ *                    each to visit; with symmetry breaking the whole orbit of every
+ *                    canonical embedding is handed on. The map buffers are shared by
+ *                    all solutions and only valid during the call.
+ * @param max_maps    stop after this many embeddings, negative for no limit
+ * @param found       number of embeddings handed to visit
+ * @return            IGRAPH_INTERRUPTED if a budget ran out before the last one
+ * @version						v0.01b
+ ****************************************************************/
+int Isosat::enumerate (igraph_integer_t max_maps, const Visitor &visit, igraph_integer_t *found) {
+
+    *found = 0;
+    if (error != IGRAPH_SUCCESS)
+        return error;
+
+    igraph_vector_t map12, map21, orbit21;
+    igraph_vector_init(&map12, v1_size);
+    igraph_vector_init(&map21, v2_size);
+    igraph_vector_init(&orbit21, v2_size);
+
+    // a projection class may hold several members of an orbit, it is handed on once
+    igraph_integer_t orbit = projected ? 1 : aut_size();
+    igraph_bool_t iso(true);
+    bool more(true);
+    int result(IGRAPH_SUCCESS);
+    enum_start();
+    while (more && (max_maps < 0 || *found < max_maps)) {
+        result = enum_next(&iso, NULL, &map21);
+        if (result != IGRAPH_SUCCESS || !iso)
+            break;
+
+        for (igraph_integer_t index = 0; index < orbit && more && (max_maps < 0 || *found < max_maps); index++) {
+            expand(&map21, index, &orbit21);
+            igraph_vector_fill(&map12, -1);
+            for (int vid2 = 0; vid2 < v2_size; vid2++)
+                if (VECTOR(orbit21)[vid2] >= 0)
+                    VECTOR(map12)[ (int)VECTOR(orbit21)[vid2] ] = vid2;
+
+            (*found)++;
+            more = visit(&map12, &orbit21);
+        }
+    }
+
+    igraph_vector_destroy(&orbit21);
+    igraph_vector_destroy(&map21);
+    igraph_vector_destroy(&map12);
+    return result;
+}
+
+
+
+/************************************************************//**
+ * @brief	
+ * @version						v0.01b
+ ****************************************************************/
+int Isosat::negate (const igraph_vector_t *map12, igraph_vector_t *map21) {
+
+    if ( (map12 == NULL && map21 == NULL) || (map12 != NULL && map21 != NULL) )
+        return IGRAPH_ARPACK_MODEINV;
+
+    if (map21 != NULL) {
+        assert ( igraph_vector_size(map21) == v2_size );
+        vec<Lit> neg_list;
+        for (unsigned int vid2 = 0; vid2 < v2_size; vid2++) {
+            int vid1 = (int)VECTOR(*map21)[vid2];
+            if (vid1 < 0 || vid1 >= v1_size)
+                continue;
+            Lit lit = translate(M21(vid2, vid1, true));
+            // pair without a variable, map can never be a solution
+            if (lit == lit_Undef)
+                return 0;
+            neg_list.push( lit );
+        }
+        solver->addClause(neg_list);
+        #ifdef DEBUG
+            cout << "negate " << formula::str(neg_list) << endl;
+        #endif
+    } else {
+        assert ( igraph_vector_size(map12) == v1_size );
+        vec<Lit> neg_list;
+        for (unsigned int vid1 = 0; vid1 < v1_size; vid1++) {
+            int vid2 = (int)VECTOR(*map12)[vid1];
+            if (vid2 >= 0 && vid2 < v2_size) {
+                Lit lit = translate(M21(vid2, vid1, true));
+                if (lit == lit_Undef)
+                    return 0;
+                neg_list.push( lit );
+            }
+        }
+        solver->addClause(neg_list);
+        #ifdef DEBUG
+            cout << "negate " << formula::str(neg_list) << endl;
+        #endif
+    }
+    return 0;
+}
+
+
+
+/************************************************************//**
+ * @brief             warm start from an (almost) right mapping: its pairs are put
+ *                    first in the decision order with a true phase, so the first
+ *                    descent follows it as far as it is consistent
+ * @param map12       hint as a map from graph1, or NULL
+ * @param map21       hint as a map from graph2, or NULL
+ * @version						v0.01b
+ ****************************************************************/
+int Isosat::hint (const igraph_vector_t *map12, const igraph_vector_t *map21) {
+
+    if ( (map12 == NULL && map21 == NULL) || (map12 != NULL && map21 != NULL) )
+        return IGRAPH_ARPACK_MODEINV;
+    if (error != IGRAPH_SUCCESS)
+        return error;
+    // the setup stops before the candidate table when no embedding can exist
+    if (!solver->okay())
+        return IGRAPH_SUCCESS;
+
+    hint_var.assign(v2_size, var_Undef);
+    if (map21 != NULL) {
+        assert ( igraph_vector_size(map21) == v2_size );
+        for (unsigned int vid2 = 0; vid2 < v2_size; vid2++) {
+            int vid1 = (int)VECTOR(*map21)[vid2];
+            if (vid1 >= 0 && vid1 < v1_size && translate(M21(vid2, vid1)) != lit_Undef)
+                hint_var[vid2] = var( translate(M21(vid2, vid1)) );
+        }
+    } else {
+        assert ( igraph_vector_size(map12) == v1_size );
+        for (unsigned int vid1 = 0; vid1 < v1_size; vid1++) {
+            int vid2 = (int)VECTOR(*map12)[vid1];
+            if (vid2 >= 0 && vid2 < v2_size && translate(M21(vid2, vid1)) != lit_Undef)
+                hint_var[vid2] = var( translate(M21(vid2, vid1)) );
+        }
+    }
+
+    apply_hint();
+    return IGRAPH_SUCCESS;
+}
+
+
+
+/************************************************************//**
+ * @brief             hints a mapping built greedily: the pattern vertex with the most
+ *                    placed neighbours (then the highest degree) goes next, onto the
+ *                    free candidate that keeps the most of those edges, ties to the
+ *                    closest degree
+ * @version						v0.01b
+ ****************************************************************/
+int Isosat::greedy_hint () {
+    if (error != IGRAPH_SUCCESS)
+        return error;
+    if (!solver->okay())
+        return IGRAPH_SUCCESS;
+
+    vector<int>  map21(v2_size, -1);
+    vector<bool> used(v1_size, false);
+    vector<int>  mark(v1_size, -1);
+
+    for (unsigned int placed = 0; placed < v2_size; placed++) {
+
+        // next pattern vertex
+        int vid2(-1), best_links(-1);
+        for (unsigned int u2 = 0; u2 < v2_size; u2++) {
+            if (map21[u2] >= 0)
+                continue;
+            int links = 0;
+            for (int j = out2.begin[u2]; j < out2.begin[u2+1]; j++)
+                links += (map21[ out2.nbr[j] ] >= 0);
+            for (int j = in2.begin[u2]; j < in2.begin[u2+1]; j++)
+                links += (map21[ in2.nbr[j] ] >= 0);
+            if (links > best_links || (links == best_links
+                    && out2.degree(u2) + in2.degree(u2) > out2.degree(vid2) + in2.degree(vid2))) {
+                vid2       = u2;
+                best_links = links;
+            }
+        }
+        int degree2 = out2.degree(vid2) + in2.degree(vid2);
+
+        // its image
+        int  best_vid1(-1), best_kept(-1), best_gap(0);
+        for (Var v = cand_begin[vid2]; v < cand_begin[vid2+1]; v++) {
+            int vid1 = cand_vid1[v];
+            if (solver->value(v) == l_False || (used[vid1] && !options.homomorphism))
+                continue;
+
+            int kept = 0;
+            for (int i = out1.begin[vid1]; i < out1.begin[vid1+1]; i++)
+                mark[ out1.nbr[i] ] = vid1;
+            for (int j = out2.begin[vid2]; j < out2.begin[vid2+1]; j++)
+                kept += (map21[ out2.nbr[j] ] >= 0 && mark[ map21[out2.nbr[j]] ] == vid1);
+            for (int i = in1.begin[vid1]; i < in1.begin[vid1+1]; i++)
+                mark[ in1.nbr[i] ] = v1_size + vid1;
+            for (int j = in2.begin[vid2]; j < in2.begin[vid2+1]; j++)
+                kept += (map21[ in2.nbr[j] ] >= 0 && mark[ map21[in2.nbr[j]] ] == v1_size + vid1);
+
+            int gap = abs(out1.degree(vid1) + in1.degree(vid1) - degree2);
+            if (kept > best_kept || (kept == best_kept && gap < best_gap)) {
+                best_vid1 = vid1;
+                best_kept = kept;
+                best_gap  = gap;
+            }
+        }
+
+        // no free candidate left, the rest stays without a hint
+        if (best_vid1 < 0)
+            break;
+        map21[vid2]     = best_vid1;
+        used[best_vid1] = true;
+    }
+
+    #ifdef DEBUG
+      cout << "greedy hint:";
+      for (unsigned int vid2 = 0; vid2 < v2_size; vid2++)
+          cout << " " << map21[vid2];
+      cout << endl;
+    #endif
+
+    hint_var.assign(v2_size, var_Undef);
+    for (unsigned int vid2 = 0; vid2 < v2_size; vid2++)
+        if (map21[vid2] >= 0)
+            hint_var[vid2] = var( translate(M21(vid2, map21[vid2])) );
+    apply_hint();
+    return IGRAPH_SUCCESS;
+}
+
+
+
+/************************************************************//**
+ * @brief             phases and decision order from hint_var
+ * @version						v0.01b
+ ****************************************************************/
+void Isosat::apply_hint () {
+    for (Var v = 0; v < n_map_vars; v++)
+        solver->setPhase(v, false);
+    for (unsigned int vid2 = 0; vid2 < hint_var.size(); vid2++) {
+        if (hint_var[vid2] == var_Undef)
+            continue;
+        solver->setPhase(hint_var[vid2], true);
+        solver->bumpVar(hint_var[vid2]);
+    }
+}
+
+
+
+/************************************************************//**
+ * @brief	
+ * @version						v0.01b
+ ****************************************************************/
+M21 Isosat::translate (const Lit &lit) {
+    assert ( var(lit) < set_size() );
+    return M21( cand_vid2[var(lit)], cand_vid1[var(lit)], sign(lit) );
+}
+
+
+
+/************************************************************//**
+ * @brief	
+ * @return            mapping literal, lit_Undef if (vid2, vid1) has no variable
+ * @version						v0.01b
+ ****************************************************************/
+Lit Isosat::translate (const M21 &lit) {
+    assert ( lit.vid1 < v1_size && lit.vid2 < v2_size );
+    vector<int>::const_iterator first = cand_vid1.begin() + cand_begin[lit.vid2];
+    vector<int>::const_iterator last  = cand_vid1.begin() + cand_begin[lit.vid2+1];
+    vector<int>::const_iterator it    = lower_bound(first, last, (int)lit.vid1);
+    if (it == last || *it != (int)lit.vid1)
+        return lit_Undef;
+    return mkLit( it - cand_vid1.begin(), lit.sign );
+}
+
+
+
+
+/********************************************************************************
+ * NonEdges Propagator
+ ********************************************************************************/
+
+
+/************************************************************//**
+ * @brief             builds the pattern adjacency matrix
+ * @version						v0.01b
+ ****************************************************************/
+void NonEdges::init (bool _directed) {
+    directed = _directed;
+    words    = (isosat.v2_size + 63) / 64;
+    adj2.assign((size_t)isosat.v2_size * words, 0);
+    for (int u2 = 0; u2 < isosat.v2_size; u2++)
+        for (int i = isosat.out2.begin[u2]; i < isosat.out2.begin[u2+1]; i++)
+            adj2[(size_t)u2*words + isosat.out2.nbr[i]/64] |= (uint64_t)1 << (isosat.out2.nbr[i] % 64);
+
+    reason_of.assign(isosat.n_map_vars, 0);
+    pushed.assign(isosat.n_map_vars, -1);
+}
+
+
+
+/************************************************************//**
+ * @brief             falsifies the pairs (v2,v1) over the neighbours v1 of u1 in adj1
+ *                    where u2 -> v2 (out) or v2 -> u2 (in) is missing from the pattern
+ * @version						v0.01b
+ ****************************************************************/
+void NonEdges::falsify (const Solver& solver, Var u, const Adjacency &adj1, bool out, vec<Lit>& lits) {
+    int u2 = isosat.cand_vid2[u];
+    int u1 = isosat.cand_vid1[u];
+
+    for (int i = adj1.begin[u1]; i < adj1.begin[u1+1]; i++) {
+        int v1 = adj1.nbr[i];
+        for (int j = isosat.col_begin[v1]; j < isosat.col_begin[v1+1]; j++) {
+            Var w  = isosat.col_var[j];
+            int v2 = isosat.cand_vid2[w];
+            if (v2 == u2 || (out ? adjacent2(u2, v2) : adjacent2(v2, u2)))
+                continue;
+            if (pushed[w] == calls || solver.value(w) == l_False)
+                continue;
+
+            reason_of[w] = u;
+            pushed[w] = calls;
+            lits.push( mkLit(w, true) );
+        }
+    }
+}
+
+
+
+/************************************************************//**
+ * @brief             called by the solver for every true mapping literal
+ * @version						v0.01b
+ ****************************************************************/
+bool NonEdges::propagate (const Solver& solver, Lit p, vec<Lit>& out) {
+    calls++;
+    falsify(solver, var(p), isosat.out1, true, out);
+    if (directed)
+        falsify(solver, var(p), isosat.in1, false, out);
+    return true;
+}
+
+
+
+/************************************************************//**
+ * @brief             reason of a pair falsified by propagate
+ * @version						v0.01b
+ ****************************************************************/
+void NonEdges::explain (const Solver& solver, Lit p, vec<Lit>& out) {
+    out.push(p);
+    out.push( mkLit(reason_of[var(p)], true) );
+}
+
+
+
+/********************************************************************************
+ * FailFirst Brancher
+ ********************************************************************************/
+
+
+/************************************************************//**
+ * @brief             orders every row by how close the target degree is to the
+ *                    pattern degree
+ * @version						v0.01b
+ ****************************************************************/
+void FailFirst::init () {
+    degree2.resize(isosat.v2_size);
+    for (int vid2 = 0; vid2 < isosat.v2_size; vid2++)
+        degree2[vid2] = isosat.out2.degree(vid2) + isosat.in2.degree(vid2);
+
+    by_closeness.resize(isosat.n_map_vars);
+    for (Var v = 0; v < isosat.n_map_vars; v++)
+        by_closeness[v] = v;
+
+    for (int vid2 = 0; vid2 < isosat.v2_size; vid2++) {
+        int degree = degree2[vid2];
+        std::stable_sort(by_closeness.begin() + isosat.cand_begin[vid2],
+                         by_closeness.begin() + isosat.cand_begin[vid2+1],
+                         [this, degree] (Var a, Var b) {
+                int vid1_a = isosat.cand_vid1[a], vid1_b = isosat.cand_vid1[b];
+                int gap_a  = isosat.out1.degree(vid1_a) + isosat.in1.degree(vid1_a) - degree;
+                int gap_b  = isosat.out1.degree(vid1_b) + isosat.in1.degree(vid1_b) - degree;
+                return abs(gap_a) < abs(gap_b);
+            });
+    }
+
+    open.resize(isosat.v2_size);
+    for (int vid2 = 0; vid2 < isosat.v2_size; vid2++)
+        open[vid2] = isosat.cand_begin[vid2+1] - isosat.cand_begin[vid2];
+    placed.assign(isosat.v2_size, 0);
+    assigned.clear();
+
+    rows.clear();
+    for (int vid2 = 0; vid2 < isosat.v2_size; vid2++)
+        update_row(vid2);
+}
+
+
+
+/************************************************************//**
+ * @brief             moves vid2 in rows after its counts changed, or takes it out
+ *                    once it is placed or has no open candidate left
+ * @version						v0.01b
+ ****************************************************************/
+void FailFirst::update_row (int vid2) {
+    if (placed[vid2] == 0 && open[vid2] > 0)
+        rows.update(vid2);
+    else if (rows.inHeap(vid2))
+        rows.remove(vid2);
+}
+
+
+
+/************************************************************//**
+ * @brief             counts the mapping literal out of the open candidates of its row
+ * @version						v0.01b
+ ****************************************************************/
+bool FailFirst::propagate (const Solver& solver, Lit p, vec<Lit>& out) {
+    int vid2 = isosat.cand_vid2[var(p)];
+    open[vid2]--;
+    if (!sign(p))
+        placed[vid2]++;
+    update_row(vid2);
+    Assigned a = { p, solver.decisionLevel() };
+    assigned.push_back(a);
+    return true;
+}
+
+
+
+/************************************************************//**
+ * @brief             reopens the candidates assigned above level
+ * @version						v0.01b
+ ****************************************************************/
+void FailFirst::backtrack (const Solver& solver, int level) {
+    while (!assigned.empty() && assigned.back().level > level) {
+        Lit p    = assigned.back().p;
+        int vid2 = isosat.cand_vid2[var(p)];
+        open[vid2]++;
+        if (!sign(p))
+            placed[vid2]--;
+        update_row(vid2);
+        assigned.pop_back();
+    }
+}
+
+
+
+/************************************************************//**
+ * @brief             positive literal of the next pair to try, lit_Undef once every
+ *                    pattern vertex is placed
+ * @version						v0.01b
+ ****************************************************************/
+Lit FailFirst::decide (const Solver& solver) {
+    if (rows.empty())
+        return lit_Undef;
+    int best = rows[0];
+
+    if (!isosat.hint_var.empty()) {
+        Var hinted = isosat.hint_var[best];
+        if (hinted != var_Undef && solver.value(hinted) == l_Undef)
+            return mkLit(hinted, false);
+    }
+
+    for (int i = isosat.cand_begin[best]; i < isosat.cand_begin[best+1]; i++)
+        if (solver.value(by_closeness[i]) == l_Undef)
+            return mkLit(by_closeness[i], false);
+    return lit_Undef;
+}
+
+
+
+/********************************************************************************
+ * ClauseRing
+ ********************************************************************************/
+
+
+/************************************************************//**
+ * @brief             writes a clause within max_size and max_lbd to the next
+ *                    position; dropped if another writer still holds the slot or
+ *                    a later one already took it
+ * @version						v0.01b
+ ****************************************************************/
+void ClauseRing::publish (int id, const vec<Lit>& clause, int lbd) {
+    if (clause.size() > max_size || lbd > max_lbd)
+        return;
+
+    uint64_t pos  = head.fetch_add(1);
+    size_t   idx  = pos % slots.size();
+    Slot    &slot = slots[idx];
+
+    uint64_t seq = slot.seq.load();
+    do {
+        if ((seq & 1) || seq >= 2*pos + 1)
+            return;
+    } while (!slot.seq.compare_exchange_weak(seq, 2*pos + 1));
+
+    std::atomic<int> *dest = &lits[idx * max_size];
+    slot.origin.store(id, std::memory_order_relaxed);
+    slot.size.store(clause.size(), std::memory_order_relaxed);
+    for (int i = 0; i < clause.size(); i++)
+        dest[i].store(toInt(clause[i]), std::memory_order_relaxed);
+    slot.seq.store(2*pos + 2, std::memory_order_release);
+}
+
+
+
+/************************************************************//**
+ * @brief             next clause of another solver, skipping the positions that
+ *                    were overwritten before id got to them
+ * @return            false if id has read up to a position still being written
+ * @version						v0.01b
+ ****************************************************************/
+bool ClauseRing::fetch (int id, vec<Lit>& out) {
+    uint64_t &pos = cursor[id];
+    uint64_t  end = head.load(std::memory_order_acquire);
+    if (end - pos > slots.size())
+        pos = end - slots.size();
+
+    for (; pos < end; pos++) {
+        size_t idx  = pos % slots.size();
+        Slot  &slot = slots[idx];
+        uint64_t seq = slot.seq.load(std::memory_order_acquire);
+        if (seq < 2*pos + 2) {
+            // a writer of an earlier lap still holds the slot, the clause of pos is dropped
+            if ((seq & 1) && seq < 2*pos + 1)
+                continue;
+            return false;
+        }
+        if (seq > 2*pos + 2 || slot.origin.load(std::memory_order_relaxed) == id)
+            continue;
+
+        out.clear();
+        const std::atomic<int> *src = &lits[idx * max_size];
+        int size = slot.size.load(std::memory_order_relaxed);
+        for (int i = 0; i < size; i++)
+            out.push( toLit(src[i].load(std::memory_order_relaxed)) );
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) != seq)
+            continue;
+
+        pos++;
+        return true;
+    }
+    return false;
+}
+
+
+
+/********************************************************************************
+ * ForwardCheck Propagator
+ ********************************************************************************/
+
+
+/************************************************************//**
+ * @brief             opens every candidate and indexes the rows for var_of
+ * @version						v0.01b
+ ****************************************************************/
+void ForwardCheck::init (bool _directed) {
+    directed = _directed;
+    words    = (isosat.v1_size + 63) / 64;
+
+    layout.assign((size_t)isosat.v2_size * words, 0);
+    for (Var v = 0; v < isosat.n_map_vars; v++) {
+        int vid1 = isosat.cand_vid1[v];
+        layout[(size_t)isosat.cand_vid2[v]*words + vid1/64] |= (uint64_t)1 << (vid1 % 64);
+    }
+
+    rank.assign((size_t)isosat.v2_size * words, 0);
+    for (int vid2 = 0; vid2 < isosat.v2_size; vid2++) {
+        int count = isosat.cand_begin[vid2];
+        for (int w = 0; w < words; w++) {
+            rank[(size_t)vid2*words + w] = count;
+            count += __builtin_popcountll(layout[(size_t)vid2*words + w]);
+        }
+    }
+
+    live = layout;
+    nbr_bits.assign(words, 0);
+    reason_of.assign(isosat.n_map_vars, 0);
+    trail.clear();
+}
+
+
+
+/************************************************************//**
+ * @brief             mapping variable of a pair whose bit is set in layout
+ * @version						v0.01b
+ ****************************************************************/
+Var ForwardCheck::var_of (int vid2, int vid1) const {
+    size_t   word  = (size_t)vid2*words + vid1/64;
+    uint64_t below = ((uint64_t)1 << (vid1 % 64)) - 1;
+    return rank[word] + __builtin_popcountll(layout[word] & below);
+}
+
+
+
+/************************************************************//**
+ * @brief             cuts the rows of the adj2 neighbours of u2 down to the adj1
+ *                    neighbours of u1, for u = M(u2,u1)
+ * @version						v0.01b
+ ****************************************************************/
+void ForwardCheck::cut (const Solver& solver, Var u, const Adjacency &adj1, const Adjacency &adj2, vec<Lit>& out) {
+    int u2 = isosat.cand_vid2[u];
+    int u1 = isosat.cand_vid1[u];
+    if (adj2.degree(u2) == 0)
+        return;
+
+    for (int i = adj1.begin[u1]; i < adj1.begin[u1+1]; i++)
+        nbr_bits[adj1.nbr[i] / 64] |= (uint64_t)1 << (adj1.nbr[i] % 64);
+
+    // most words lose nothing, the vector paths skip a block of them at once
+    // and leave the rest to cut_word
+    for (int j = adj2.begin[u2]; j < adj2.begin[u2+1]; j++) {
+        int v2 = adj2.nbr[j];
+        const uint64_t *row = &live[(size_t)v2 * words];
+        int w = 0;
+        #if defined(__AVX2__)
+          for (; w + 4 <= words; w += 4) {
+              __m256i bits = _mm256_loadu_si256((const __m256i*)&row[w]);
+              __m256i nbrs = _mm256_loadu_si256((const __m256i*)&nbr_bits[w]);
+              if (_mm256_testc_si256(nbrs, bits))
+                  continue;
+              for (int k = w; k < w + 4; k++)
+                  cut_word(solver, u, v2, k, out);
+          }
+        #elif defined(__SSE2__)
+          for (; w + 2 <= words; w += 2) {
+              __m128i bits = _mm_loadu_si128((const __m128i*)&row[w]);
+              __m128i nbrs = _mm_loadu_si128((const __m128i*)&nbr_bits[w]);
+              __m128i removed = _mm_andnot_si128(nbrs, bits);
+              if (_mm_movemask_epi8(_mm_cmpeq_epi8(removed, _mm_setzero_si128())) == 0xFFFF)
+                  continue;
+              cut_word(solver, u, v2, w, out);
+              cut_word(solver, u, v2, w+1, out);
+          }
+        #endif
+        for (; w < words; w++)
+            cut_word(solver, u, v2, w, out);
+    }
+
+    for (int i = adj1.begin[u1]; i < adj1.begin[u1+1]; i++)
+        nbr_bits[adj1.nbr[i] / 64] = 0;
+}
+
+
+
+/************************************************************//**
+ * @brief             clears the live bits of word w of row v2 outside nbr_bits
+ *                    and falsifies the pairs that were still open
+ * @version						v0.01b
+ ****************************************************************/
+void ForwardCheck::cut_word (const Solver& solver, Var u, int v2, int w, vec<Lit>& out) {
+    uint64_t &word = live[(size_t)v2*words + w];
+    uint64_t removed = word & ~nbr_bits[w];
+    if (removed == 0)
+        return;
+
+    word &= nbr_bits[w];
+    Cut c = { (int)((size_t)v2*words + w), removed, solver.decisionLevel() };
+    trail.push_back(c);
+    for (uint64_t bits = removed; bits != 0; bits &= bits - 1) {
+        Var v = var_of(v2, w*64 + __builtin_ctzll(bits));
+        if (solver.value(v) == l_False)
+            continue;
+        reason_of[v] = u;
+        out.push( mkLit(v, true) );
+    }
+}
+
+
+
+/************************************************************//**
+ * @brief             called by the solver for every true mapping literal
+ * @version						v0.01b
+ ****************************************************************/
+bool ForwardCheck::propagate (const Solver& solver, Lit p, vec<Lit>& out) {
+    Var v = var(p);
+    cut(solver, v, isosat.out1, isosat.out2, out);
+    if (directed)
+        cut(solver, v, isosat.in1, isosat.in2, out);
+    return true;
+}
+
+
+
+/************************************************************//**
+ * @brief             reason of a pair falsified by cut
+ * @version						v0.01b
+ ****************************************************************/
+void ForwardCheck::explain (const Solver& solver, Lit p, vec<Lit>& out) {
+    out.push(p);
+    out.push( mkLit(reason_of[var(p)], true) );
+}
+
+
+
+/************************************************************//**
+ * @brief             reopens the candidates cleared above level
+ * @version						v0.01b
+ ****************************************************************/
+void ForwardCheck::backtrack (const Solver& solver, int level) {
+    while (!trail.empty() && trail.back().level > level) {
+        live[ trail.back().word ] |= trail.back().bits;
+        trail.pop_back();
+    }
+}
+
+
+
+/********************************************************************************
+ * AllDifferent Propagator
+ ********************************************************************************/
+
+
+/************************************************************//**
+ * @brief             sizes the state once the candidate table is built
+ * @version						v0.01b
+ ****************************************************************/
+void AllDifferent::init (bool _injective, bool _matching) {
+    injective = _injective;
+    matching  = _matching;
+    reason_of.assign(isosat.n_map_vars, 0);
+    pushed.assign(isosat.n_map_vars, -1);
+    mate2.assign(isosat.v2_size, -1);
+    mate1.assign(isosat.v1_size, -1);
+    visit2.assign(isosat.v2_size, 0);
+    visit1.assign(isosat.v1_size, 0);
+
+    int v2_size = isosat.v2_size;
+    numbered.assign(v2_size, -1);
+    order.assign(v2_size, 0);
+    low.assign(v2_size, 0);
+    comp.assign(v2_size, -1);
+    touches.assign(v2_size, 0);
+    event_of.assign(v2_size, -1);
+    comp_free.reserve(v2_size);
+    tarjan.reserve(v2_size);
+    frame_vid2.reserve(v2_size);
+    frame_var.reserve(v2_size);
+    todo.reserve(v2_size);
+    closed.reserve(v2_size);
+}
+
+
+
+/************************************************************//**
+ * @brief             a pair is an edge of the matching graph until it is false
+ * @version						v0.01b
+ ****************************************************************/
+bool AllDifferent::edge (const Solver& solver, Var v) const {
+    return solver.value(v) != l_False;
+}
+
+
+
+/************************************************************//**
+ * @brief             finds an augmenting path from the free pattern vertex vid2
+ *                    targets tried in this search are marked with the current stamp
+ * @version						v0.01b
+ ****************************************************************/
+bool AllDifferent::augment (const Solver& solver, int vid2) {
+    visit2[vid2] = stamp;
+
+    for (Var v = isosat.cand_begin[vid2]; v < isosat.cand_begin[vid2+1]; v++) {
+        int vid1 = isosat.cand_vid1[v];
+        if (mate1[vid1] < 0 && edge(solver, v)) {
+            mate1[vid1] = vid2;
+            mate2[vid2] = v;
+            return true;
+        }
+    }
+
+    for (Var v = isosat.cand_begin[vid2]; v < isosat.cand_begin[vid2+1]; v++) {
+        int vid1 = isosat.cand_vid1[v];
+        if (visit1[vid1] == stamp || !edge(solver, v))
+            continue;
+
+        visit1[vid1] = stamp;
+        if (augment(solver, mate1[vid1])) {
+            mate1[vid1] = vid2;
+            mate2[vid2] = v;
+            return true;
+        }
+    }
+    return false;
+}
+
+
+
+/************************************************************//**
+ * @brief             records the Hall set of pattern vertices reachable from vid2
+ *                    along alternating paths: they use up exactly their matched
+ *                    targets as long as their other pairs stay false
+ * @return            event index
+ * @version						v0.01b
+ ****************************************************************/
+int AllDifferent::hall_event (const Solver& solver, int vid2) {
+    stamp++;
+    todo.assign(1, vid2);
+    closed.clear();
+    visit2[vid2] = stamp;
+    while (!todo.empty()) {
+        int a = todo.back();
+        todo.pop_back();
+        closed.push_back(a);
+        visit1[ isosat.cand_vid1[mate2[a]] ] = stamp;
+        for (Var v = isosat.cand_begin[a]; v < isosat.cand_begin[a+1]; v++) {
+            if (!edge(solver, v))
+                continue;
+            int b = mate1[ isosat.cand_vid1[v] ];
+            assert (b >= 0);
+            if (visit2[b] != stamp) {
+                visit2[b] = stamp;
+                todo.push_back(b);
+            }
+        }
+    }
+
+    hall_level.push_back(solver.decisionLevel());
+    hall_begin.push_back(hall_lits.size());
+    for (unsigned int i = 0; i < closed.size(); i++) {
+        int c = closed[i];
+        for (Var v = isosat.cand_begin[c]; v < isosat.cand_begin[c+1]; v++)
+            if (visit1[ isosat.cand_vid1[v] ] != stamp) {
+                assert (!edge(solver, v));
+                hall_lits.push_back( mkLit(v, false) );
+            }
+    }
+    return hall_level.size() - 1;
+}
+
+
 
+/************************************************************//**
+ * @brief             repairs the matching and prunes pairs that lie in no matching
+ *                    of all pattern vertices (Regin): (a,x) with x matched to b is
+ *                    kept if b reaches a or a free target along alternating paths
+ * @return            false with a Hall violation in out if no matching exists
+ * @version						v0.01b
+ ****************************************************************/
+bool AllDifferent::filter (const Solver& solver, vec<Lit>& out) {
+    int v2_size = isosat.v2_size;
+    const vector<int> &cand_begin = isosat.cand_begin;
+    const vector<int> &cand_vid1  = isosat.cand_vid1;
+
+    /******************************
+     * Matching
+     * drop pairs that became false, then augment every free pattern vertex
+     ******************************/
+    for (int vid2 = 0; vid2 < v2_size; vid2++) {
+        if (mate2[vid2] >= 0 && !edge(solver, mate2[vid2])) {
+            mate1[ cand_vid1[mate2[vid2]] ] = -1;
+            mate2[vid2] = -1;
+        }
+    }
+
+    for (int vid2 = 0; vid2 < v2_size; vid2++) {
+        if (mate2[vid2] >= 0)
+            continue;
+
+        stamp++;
+        if (!augment(solver, vid2)) {
+            // the searched pattern vertices only have the searched targets, one too few
+            out.clear();
+            for (int c = 0; c < v2_size; c++) {
+                if (visit2[c] != stamp)
+                    continue;
+                for (Var v = cand_begin[c]; v < cand_begin[c+1]; v++)
+                    if (visit1[ cand_vid1[v] ] != stamp)
+                        out.push( mkLit(v, false) );
+            }
+            #ifdef DEBUG
+                cout << "hall_conflict: " << formula::str(out) << endl;
+            #endif
+            return false;
+        }
+    }
+
+    /******************************
+     * Alternating graph a -> mate1[x] over the pairs (a,x)
+     * components in reverse topological order (Tarjan), flagged if they reach a free target
+     ******************************/
+    comp_free.clear();
+    int counter = 0;
+
+    for (int root = 0; root < v2_size; root++) {
+        if (numbered[root] == calls)
+            continue;
+
+        numbered[root] = calls;
+        order[root] = low[root] = counter++;
+        comp[root] = -1;
+        touches[root] = 0;
+        tarjan.push_back(root);
+        frame_vid2.push_back(root);
+        frame_var.push_back(cand_begin[root]);
+
+        while (!frame_vid2.empty()) {
+            int a = frame_vid2.back();
+            if (frame_var.back() < cand_begin[a+1]) {
+                Var v = frame_var.back()++;
+                if (!edge(solver, v))
+                    continue;
+
+                int b = mate1[ cand_vid1[v] ];
+                if (b < 0)
+                    touches[a] = 1;
+                else if (numbered[b] != calls) {
+                    numbered[b] = calls;
+                    order[b] = low[b] = counter++;
+                    comp[b] = -1;
+                    touches[b] = 0;
+                    tarjan.push_back(b);
+                    frame_vid2.push_back(b);
+                    frame_var.push_back(cand_begin[b]);
+                } else if (comp[b] < 0)
+                    low[a] = min(low[a], order[b]);
+                else
+                    touches[a] |= comp_free[comp[b]];
+                continue;
+            }
+
+            frame_vid2.pop_back();
+            frame_var.pop_back();
+            if (low[a] == order[a]) {
+                char reach_free = 0;
+                int b;
+                do {
+                    b = tarjan.back();
+                    tarjan.pop_back();
+                    comp[b] = comp_free.size();
+                    reach_free |= touches[b];
+                } while (b != a);
+                event_of[comp_free.size()] = -1;
+                comp_free.push_back(reach_free);
+            }
+            if (!frame_vid2.empty()) {
+                int parent = frame_vid2.back();
+                low[parent] = min(low[parent], low[a]);
+                if (comp[a] >= 0)
+                    touches[parent] |= comp_free[comp[a]];
+            }
+        }
+    }
+
+    /******************************
+     * Pruning
+     * one Hall event per closed component, shared by all pairs it prunes
+     ******************************/
+    for (int a = 0; a < v2_size; a++) {
+        for (Var v = cand_begin[a]; v < cand_begin[a+1]; v++) {
+            if (v == mate2[a] || pushed[v] == calls || !edge(solver, v))
+                continue;
+
+            int b = mate1[ cand_vid1[v] ];
+            if (b < 0 || comp[b] == comp[a] || comp_free[comp[b]])
+                continue;
+
+            if (event_of[comp[b]] < 0)
+                event_of[comp[b]] = hall_event(solver, b);
+            reason_of[v] = -(event_of[comp[b]] + 1);
+            pushed[v] = calls;
+            out.push( mkLit(v, true) );
+        }
+    }
+
+    return true;
+}
+
+
+
+/************************************************************//**
+ * @brief             called by the solver for every mapping literal
+ * @version						v0.01b
+ ****************************************************************/
+bool AllDifferent::propagate (const Solver& solver, Lit p, vec<Lit>& out) {
+    Var v    = var(p);
+    int vid2 = isosat.cand_vid2[v];
+    int vid1 = isosat.cand_vid1[v];
+    calls++;
+
+    if (sign(p)) {
+        // a false pair only matters once the matching has lost it
+        if (matching && mate2[vid2] == v)
+            return filter(solver, out);
+        return true;
+    }
+
+    // negate all other variables in row
+    for (Var w = isosat.cand_begin[vid2]; w < isosat.cand_begin[vid2+1]; w++) {
+        if (w != v && solver.value(w) != l_False) {
+            reason_of[w] = v;
+            pushed[w] = calls;
+            out.push( mkLit(w, true) );
+        }
+    }
+
+    // negate all other variables in column
+    for (int i = isosat.col_begin[vid1]; i < isosat.col_begin[vid1+1] && injective; i++) {
+        Var w = isosat.col_var[i];
+        if (w != v && solver.value(w) != l_False) {
+            reason_of[w] = v;
+            pushed[w] = calls;
+            out.push( mkLit(w, true) );
+        }
+    }
+
+    #ifdef DEBUG
+        cout << "new_decide: " << formula::str(p) << endl;
+        cout << "infer_list: " << formula::str(out) << endl;
+    #endif
+
+    if (matching && mate2[vid2] != v)
+        return filter(solver, out);
+    return true;
+}
+
+
+
+/************************************************************//**
+ * @brief             reason of a pair falsified by propagate or filter
+ * @version						v0.01b
+ ****************************************************************/
+void AllDifferent::explain (const Solver& solver, Lit p, vec<Lit>& out) {
+    assert (sign(p));
+    int reason = reason_of[var(p)];
+    out.push(p);
+    if (reason >= 0) {
+        out.push( mkLit(reason, true) );
+        return;
+    }
+
+    int event = -reason - 1;
+    int end   = (event+1 < (int)hall_begin.size()) ? hall_begin[event+1] : hall_lits.size();
+    for (int i = hall_begin[event]; i < end; i++)
+        out.push( hall_lits[i] );
+}
+
+
+
+/************************************************************//**
+ * @brief             drops the Hall events above level, the matching is kept
+ * @version						v0.01b
+ ****************************************************************/
+void AllDifferent::backtrack (const Solver& solver, int level) {
+    while (!hall_level.empty() && hall_level.back() > level) {
+        hall_lits.resize(hall_begin.back());
+        hall_begin.pop_back();
+        hall_level.pop_back();
+    }
+}
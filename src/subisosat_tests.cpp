@@ -38,6 +38,17 @@ int rand_int (int low, int high) {
 
 
 
+/************************************************************//**
+ * @brief             counts the mappings handed over into *arg
+ * @version						v0.01b
+ ****************************************************************/
+igraph_bool_t count_maps (const igraph_vector_t *map12, const igraph_vector_t *map21, void *arg) {
+    (*(int*) arg)++;
+    return true;
+}
+
+
+
 /************************************************************//**
  * @brief	
  * @version						v0.01b
@@ -131,6 +142,42 @@ int main(int argc, char **argv) {
     if (igraph_subisomorphic_sat(&graph1, &graph2,0,0,0,0,&iso,0,0,0,0,0) == IGRAPH_SUCCESS)
         cout << "  subisosat(G,H): " << string( (iso) ? "True":"False" ) << endl;
 
+    if (igraph_subisomorphic_sat(&graph1, &graph2,0,0,0,0,&iso,0,0,0,0,0,false,4) == IGRAPH_SUCCESS)
+        cout << " psubisosat(G,H): " << string( (iso) ? "True":"False" ) << endl;
+
+    if (igraph_subisomorphic_sat(&graph1, &graph2,0,0,0,0,&iso,0,0,0,0,0,false,4,true) == IGRAPH_SUCCESS)
+        cout << " csubisosat(G,H): " << string( (iso) ? "True":"False" ) << endl;
+
+    IsosatOpts simp_opts;
+    simp_opts.simplify = true;
+    Isosat simp_isosat(&graph1, &graph2,0,0,0,0,0,0,0,simp_opts);
+    if (simp_isosat.solve(&iso,0,0) == IGRAPH_SUCCESS)
+        cout << " ssubisosat(G,H): " << string( (iso) ? "True":"False" ) << endl;
+
+    IsosatOpts greedy_opts;
+    greedy_opts.greedy_start = true;
+    Isosat greedy_isosat(&graph1, &graph2,0,0,0,0,0,0,0,greedy_opts);
+    if (greedy_isosat.solve(&iso,0,0) == IGRAPH_SUCCESS)
+        cout << " gsubisosat(G,H): " << string( (iso) ? "True":"False" ) << endl;
+
+    igraph_vector_t hint21;
+    igraph_vector_init(&hint21, igraph_vcount(&graph2));
+    igraph_vector_fill(&hint21, -1);
+    igraph_subisomorphic_sat(&graph1, &graph2,0,0,0,0,&iso,0,&hint21,0,0,0);
+    Isosat hint_isosat(&graph1, &graph2,0,0,0,0,0,0,0);
+    if (hint_isosat.hint(NULL, &hint21) == IGRAPH_SUCCESS && hint_isosat.solve(&iso,0,0) == IGRAPH_SUCCESS)
+        cout << " hsubisosat(G,H): " << string( (iso) ? "True":"False" ) << endl;
+    igraph_vector_destroy(&hint21);
+
+    if (igraph_subisomorphic_lad(&graph2, &graph1,0,&iso,0,0,true,0) == IGRAPH_SUCCESS)
+        cout << "     indiso(G,H): " << string( (iso) ? "True":"False" ) << endl;
+
+    if (igraph_subisomorphic_sat(&graph1, &graph2,0,0,0,0,&iso,0,0,0,0,0,true) == IGRAPH_SUCCESS)
+        cout << "  indisosat(G,H): " << string( (iso) ? "True":"False" ) << endl;
+
+    if (igraph_homomorphic_sat(&graph1, &graph2,0,0,0,0,&iso,0,0,0,0) == IGRAPH_SUCCESS)
+        cout << "     homsat(G,H): " << string( (iso) ? "True":"False" ) << endl;
+
     if (igraph_count_subisomorphisms_vf2(&graph1, &graph2,0,0,0,0,&count,0,0,0) == IGRAPH_SUCCESS)
         cout << "    #subiso(G,H): " << count << endl;
 
@@ -138,6 +185,35 @@ int main(int argc, char **argv) {
                                          &igraph_compare_transitives,0,0) == IGRAPH_SUCCESS)
         cout << " #subisosat(G,H): " << count << endl;
 
+    if (igraph_count_subisomorphisms_sat(&graph1, &graph2,0,0,0,0,&count,
+                                         &igraph_compare_transitives,0,0,false,4) == IGRAPH_SUCCESS)
+        cout << "#psubisosat(G,H): " << count << endl;
+
+    igraph_bool_t reached;
+    if (igraph_count_subisomorphisms_sat(&graph1, &graph2,0,0,0,0,&count,0,0,0,false,1,10,&reached) == IGRAPH_SUCCESS)
+        cout << "#tsubisosat(G,H): " << count << string( (reached) ? " (reached 10)":"" ) << endl;
+
+    if (igraph_count_subisomorphisms_sat(&graph1, &graph2,0,0,0,0,&count,0,0,0,false,4,10,&reached) == IGRAPH_SUCCESS)
+        cout << "#tpsubisosat(G,H): " << count << string( (reached) ? " (reached 10)":"" ) << endl;
+
+    igraph_vector_ptr_t maps;
+    igraph_vector_ptr_init(&maps, 0);
+    if (igraph_get_subisomorphisms_sat(&graph1, &graph2,0,0,0,0,&maps,0,0,0,0,0) == IGRAPH_SUCCESS)
+        cout << " |subisosat(G,H)|: " << (int) igraph_vector_ptr_size(&maps) << endl;
+    igraph_vector_ptr_destroy_all(&maps);
+
+    igraph_vector_ptr_init(&maps, 0);
+    if (igraph_get_subisomorphisms_sat(&graph1, &graph2,0,0,0,0,&maps,0,0,0,0,0,false,10,&reached) == IGRAPH_SUCCESS)
+        cout << "|tsubisosat(G,H)|: " << (int) igraph_vector_ptr_size(&maps) << string( (reached) ? " (reached 10)":"" ) << endl;
+    igraph_vector_ptr_destroy_all(&maps);
+
+    count = 0;
+    if (igraph_subisomorphic_function_sat(&graph1, &graph2,0,0,0,0,0,0,&count_maps,0,0,&count,false,10,&reached) == IGRAPH_SUCCESS)
+        cout << "  fsubisosat(G,H): " << count << string( (reached) ? " (reached 10)":"" ) << endl;
+
+    if (igraph_count_subisomorphisms_projected_sat(&graph1, &graph2,0,0,0,0,0,&count,0,0,0) == IGRAPH_SUCCESS)
+        cout << "#imgsubisosat(G,H): " << count << endl;
+
 }
 
 